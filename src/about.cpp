@@ -179,7 +179,7 @@ void About::setTitle(const string &what)
 
 void About::setMetadata(const Metadata *metadata, const bool substitution)
 {
-  string aboutText = metadata->about();
+  string aboutText = metadata->about().to_string();
 
   if(substitution) {
     boost::replace_all(aboutText, "[[REAPACK_VERSION]]", ReaPack::VERSION);
@@ -329,11 +329,11 @@ void AboutIndexDelegate::initInstalledFiles()
   set<Registry::File> allFiles;
 
   try {
-    Registry reg(Path::prefixRoot(Path::REGISTRY));
-    for(const Registry::Entry &entry : reg.getEntries(m_index->name())) {
-      const vector<Registry::File> &files = reg.getFiles(entry);
-      allFiles.insert(files.begin(), files.end());
-    }
+    Registry reg(Path::prefixRoot(Path::REGISTRY), Registry::ReadOnly);
+    reg.forEachEntry(m_index->name(),
+      [&] (const Registry::Entry &, const vector<Registry::File> &files) {
+        allFiles.insert(files.begin(), files.end());
+      });
   }
   catch(const reapack_error &e) {
     const auto_string &desc = make_autostring(e.what());
@@ -447,7 +447,7 @@ void AboutIndexDelegate::aboutPackage()
   VersionName current;
 
   try {
-    Registry reg(Path::prefixRoot(Path::REGISTRY));
+    Registry reg(Path::prefixRoot(Path::REGISTRY), Registry::ReadOnly);
     current = reg.getEntry(pkg).version;
   }
   catch(const reapack_error &) {}
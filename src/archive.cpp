@@ -27,9 +27,12 @@
 
 #include <boost/format.hpp>
 #include <fstream>
+#include <functional>
 #include <iomanip>
+#include <map>
 #include <sstream>
 
+#include <zlib/zlib.h>
 #include <zlib/zip.h>
 #include <zlib/unzip.h>
 #include <zlib/ioapi.h>
@@ -39,6 +42,8 @@ using namespace std;
 
 static const Path ARCHIVE_TOC = Path("toc");
 static const size_t BUFFER_SIZE = 4096;
+// larger files are compressed into a temporary file instead of memory
+static const int64_t MAX_BUFFERED_SIZE = 32 << 20;
 
 #ifdef _WIN32
 static void *wide_fopen(voidpf, const void *filename, int mode)
@@ -253,7 +258,7 @@ size_t Archive::create(const auto_string &path, vector<string> *errors,
   vector<ThreadTask *> jobs;
 
   stringstream toc;
-  Registry reg(Path::prefixRoot(Path::REGISTRY));
+  Registry reg(Path::prefixRoot(Path::REGISTRY), Registry::ReadOnly);
 
   ArchiveWriterPtr writer = make_shared<ArchiveWriter>(path);
 
@@ -266,35 +271,43 @@ size_t Archive::create(const auto_string &path, vector<string> *errors,
     }
   };
 
-  for(const Remote &remote : reapack->config()->remotes.getEnabled()) {
-    bool addedRemote = false;
+  map<string, Remote> remotes;
+  for(const Remote &remote : reapack->config()->remotes.getEnabled())
+    remotes.emplace(remote.name(), remote);
 
-    for(const Registry::Entry &entry : reg.getEntries(remote.name())) {
-      ++count;
+  // entries of a remote are always consecutive
+  string lastRemote;
 
-      if(!addedRemote) {
-        toc << "REPO " << remote.toString() << '\n';
-        compress(Index::pathFor(remote.name()));
-        addedRemote = true;
-      }
+  reg.forEachEntry([&] (const Registry::Entry &entry,
+      const vector<Registry::File> &files) {
+    const auto remote = remotes.find(entry.remote);
+
+    if(remote == remotes.end())
+      return;
 
-      toc << "PACK "
-        << quoted(entry.category) << '\x20'
-        << quoted(entry.package) << '\x20'
-        << quoted(entry.version.toString()) << '\x20'
-        << entry.pinned << '\n'
-      ;
+    ++count;
 
-      for(const Registry::File &file : reg.getFiles(entry))
-        compress(file.path);
+    if(entry.remote != lastRemote) {
+      toc << "REPO " << remote->second.toString() << '\n';
+      compress(Index::pathFor(entry.remote));
+      lastRemote = entry.remote;
     }
-  }
+
+    toc << "PACK "
+      << quoted(entry.category) << '\x20'
+      << quoted(entry.package) << '\x20'
+      << quoted(entry.version.toString()) << '\x20'
+      << entry.pinned << '\n'
+    ;
+
+    for(const Registry::File &file : files)
+      compress(file.path);
+  });
 
   writer->addFile(ARCHIVE_TOC, toc);
 
-  // Start after we've written the table of contents in the main thread
-  // because we cannot safely write into the zip from more than one
-  // thread at the same time.
+  // The files are compressed in parallel, only appending them to the zip
+  // is serialized by the writer. The table of contents always comes first.
   for(ThreadTask *job : jobs)
     pool->push(job);
 
@@ -333,6 +346,8 @@ int ArchiveWriter::addFile(const Path &path)
 
 int ArchiveWriter::addFile(const Path &path, istream &stream) noexcept
 {
+  WDL_MutexLock lock(&m_mutex);
+
   const int status = zipOpenNewFileInZip(m_zip, path.join('/').c_str(), nullptr,
     nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_DEFAULT_COMPRESSION);
 
@@ -356,6 +371,106 @@ int ArchiveWriter::addFile(const Path &path, istream &stream) noexcept
   return zipCloseFileInZip(m_zip);
 }
 
+int ArchiveWriter::addCompressedFile(const Path &path, const string &deflated,
+  const uint32_t crc, const size_t size) noexcept
+{
+  WDL_MutexLock lock(&m_mutex);
+
+  const int status = zipOpenNewFileInZip2(m_zip, path.join('/').c_str(),
+    nullptr, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED,
+    Z_DEFAULT_COMPRESSION, true);
+
+  if(status != ZIP_OK)
+    return status;
+
+  zipWriteInFileInZip(m_zip, deflated.data(), (unsigned)deflated.size());
+
+  return zipCloseFileInZipRaw(m_zip, size, crc);
+}
+
+int ArchiveWriter::addCompressedFile(const Path &path, FILE *deflated,
+  const uint32_t crc, const size_t size) noexcept
+{
+  WDL_MutexLock lock(&m_mutex);
+
+  int status = zipOpenNewFileInZip2(m_zip, path.join('/').c_str(),
+    nullptr, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED,
+    Z_DEFAULT_COMPRESSION, true);
+
+  if(status != ZIP_OK)
+    return status;
+
+  string buffer(BUFFER_SIZE, 0);
+
+  while(const size_t len = fread(&buffer[0], 1, buffer.size(), deflated)) {
+    status = zipWriteInFileInZip(m_zip, &buffer[0], (unsigned)len);
+
+    if(status != ZIP_OK)
+      break;
+  }
+
+  if(status == ZIP_OK && ferror(deflated))
+    status = Z_ERRNO; // read error
+
+  const int closeStatus = zipCloseFileInZipRaw(m_zip, size, crc);
+
+  return status == ZIP_OK ? closeStatus : status;
+}
+
+// Compresses a whole stream the way minizip would (raw deflate without zlib
+// header) so it can be appended to the zip as is.
+static int deflateStream(istream &stream,
+  const std::function<bool (const char *, size_t)> &write,
+  uint32_t *crc, size_t *size)
+{
+  z_stream zs{};
+  int status = deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+    -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+
+  if(status != Z_OK)
+    return status;
+
+  string in(BUFFER_SIZE, 0), out(BUFFER_SIZE, 0);
+  uLong value = crc32(0L, Z_NULL, 0);
+  int flush;
+
+  *size = 0;
+
+  do {
+    stream.read(&in[0], in.size());
+    const uInt len = static_cast<uInt>(stream.gcount());
+
+    if(stream.bad()) {
+      deflateEnd(&zs);
+      return Z_ERRNO; // read error
+    }
+
+    value = crc32(value, reinterpret_cast<const Bytef *>(&in[0]), len);
+    *size += len;
+
+    flush = stream.eof() ? Z_FINISH : Z_NO_FLUSH;
+    zs.next_in = reinterpret_cast<Bytef *>(&in[0]);
+    zs.avail_in = len;
+
+    do {
+      zs.next_out = reinterpret_cast<Bytef *>(&out[0]);
+      zs.avail_out = static_cast<uInt>(out.size());
+      status = deflate(&zs, flush);
+
+      if(!write(&out[0], out.size() - zs.avail_out)) {
+        deflateEnd(&zs);
+        return Z_ERRNO; // write error
+      }
+    } while(zs.avail_out == 0);
+  } while(flush != Z_FINISH);
+
+  deflateEnd(&zs);
+
+  *crc = static_cast<uint32_t>(value);
+
+  return status == Z_STREAM_END ? Z_OK : status;
+}
+
 FileCompressor::FileCompressor(const Path &target, const ArchiveWriterPtr &writer)
   : m_path(target), m_writer(writer)
 {
@@ -377,7 +492,45 @@ void FileCompressor::run(DownloadContext *)
     return;
   }
 
-  const int error = m_writer->addFile(m_path, stream);
+  int64_t size;
+  time_t mtime;
+  uint32_t crc;
+  size_t length;
+  int error;
+
+  // the compression itself runs outside of the writer's lock, which is only
+  // held while copying the deflated data into the archive
+  if(!FS::stat(m_path, &size, &mtime))
+    error = m_writer->addFile(m_path, stream);
+  else if(size <= MAX_BUFFERED_SIZE) {
+    string deflated;
+
+    error = deflateStream(stream, [&] (const char *data, const size_t len) {
+      deflated.append(data, len);
+      return true;
+    }, &crc, &length);
+
+    if(!error)
+      error = m_writer->addCompressedFile(m_path, deflated, crc, length);
+  }
+  else if(FILE *deflated = tmpfile()) {
+    error = deflateStream(stream, [&] (const char *data, const size_t len) {
+      return fwrite(data, 1, len, deflated) == len;
+    }, &crc, &length);
+
+    if(!error && fflush(deflated))
+      error = Z_ERRNO; // write error
+
+    if(!error) {
+      rewind(deflated);
+      error = m_writer->addCompressedFile(m_path, deflated, crc, length);
+    }
+
+    fclose(deflated);
+  }
+  else
+    error = m_writer->addFile(m_path, stream);
+
   stream.close();
 
   if(error) {
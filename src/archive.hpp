@@ -22,6 +22,8 @@
 #include "path.hpp"
 #include "thread.hpp"
 
+#include <cstdio>
+
 class ReaPack;
 class ThreadPool;
 
@@ -46,15 +48,21 @@ private:
 
 typedef std::shared_ptr<ArchiveReader> ArchiveReaderPtr;
 
+// safe to use from multiple threads, entries are appended one at a time
 class ArchiveWriter {
 public:
   ArchiveWriter(const auto_string &path);
   ~ArchiveWriter();
   int addFile(const Path &fn);
   int addFile(const Path &fn, std::istream &) noexcept;
+  int addCompressedFile(const Path &fn, const std::string &deflated,
+    uint32_t crc, size_t size) noexcept;
+  int addCompressedFile(const Path &fn, FILE *deflated,
+    uint32_t crc, size_t size) noexcept;
 
 private:
   zipFile m_zip;
+  WDL_Mutex m_mutex;
 };
 
 typedef std::shared_ptr<ArchiveWriter> ArchiveWriterPtr;
@@ -76,7 +84,7 @@ class FileCompressor : public ThreadTask {
 public:
   FileCompressor(const Path &target, const ArchiveWriterPtr &);
 
-  bool concurrent() const override { return false; }
+  bool concurrent() const override { return true; }
   void run(DownloadContext *) override;
 
 private:
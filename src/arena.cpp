@@ -0,0 +1,74 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "arena.hpp"
+
+#include <boost/range/adaptor/reversed.hpp>
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+
+Arena::Arena(const size_t blockSize)
+  : m_blockSize(blockSize), m_cursor(nullptr), m_end(nullptr)
+{
+}
+
+Arena::~Arena()
+{
+  for(const Destructor &dtor : m_destructors | boost::adaptors::reversed)
+    dtor.call(dtor.object);
+
+  // the blocks must outlive the destructors above
+  for(char *block : m_blocks)
+    delete[] block;
+}
+
+void *Arena::allocate(const size_t size, const size_t align)
+{
+  const auto aligned = [align] (char *ptr) {
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+    return ptr + ((align - addr % align) % align);
+  };
+
+  char *ptr = aligned(m_cursor);
+
+  if(!m_cursor || ptr + size > m_end) {
+    // oversized allocations get a block of their own
+    const size_t blockSize = max(m_blockSize, size + align);
+    char *block = new char[blockSize];
+    m_blocks.push_back(block);
+
+    ptr = aligned(block);
+
+    if(blockSize > m_blockSize) // keep using the current block
+      return ptr;
+
+    m_end = block + blockSize;
+  }
+
+  m_cursor = ptr + size;
+  return ptr;
+}
+
+const char *Arena::copy(const char *str)
+{
+  const size_t size = strlen(str) + 1;
+  char *mem = static_cast<char *>(allocate(size, 1));
+  memcpy(mem, str, size);
+  return mem;
+}
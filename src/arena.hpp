@@ -0,0 +1,71 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_ARENA_HPP
+#define REAPACK_ARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator releasing its memory at once when destroyed.
+// Only the allocations are batched: objects that are not trivially
+// destructible still have their destructor called one by one (in the
+// reverse order of their construction) before the blocks are freed.
+class Arena {
+public:
+  Arena(size_t blockSize = 32 * 1024);
+  Arena(const Arena &) = delete;
+  ~Arena();
+
+  template<typename T, typename... Args>
+  T *make(Args &&... args)
+  {
+    void *mem = allocate(sizeof(T), alignof(T));
+    T *obj = new (mem) T(std::forward<Args>(args)...);
+
+    if(!std::is_trivially_destructible<T>::value)
+      m_destructors.push_back({&destroy<T>, obj});
+
+    return obj;
+  }
+
+  void *allocate(size_t size, size_t align = alignof(std::max_align_t));
+  const char *copy(const char *str);
+
+  bool empty() const { return m_blocks.empty(); }
+  size_t blockCount() const { return m_blocks.size(); }
+
+private:
+  struct Destructor {
+    void (*call)(void *);
+    void *object;
+  };
+
+  template<typename T>
+  static void destroy(void *obj) { static_cast<T *>(obj)->~T(); }
+
+  size_t m_blockSize;
+  char *m_cursor;
+  char *m_end;
+  std::vector<char *> m_blocks;
+  std::vector<Destructor> m_destructors;
+};
+
+#endif
@@ -28,6 +28,8 @@
 #include "transaction.hpp"
 
 #include <boost/range/adaptor/reversed.hpp>
+#include <tuple>
+#include <unordered_set>
 
 using namespace std;
 
@@ -51,9 +53,15 @@ enum Action {
 
 enum Timers { TIMER_FILTER = 1, TIMER_ABOUT };
 
+static bool SameState(const Registry::Entry &a, const Registry::Entry &b)
+{
+  return a.pinned == b.pinned &&
+    a.version.toString() == b.version.toString();
+}
+
 Browser::Browser(ReaPack *reapack)
   : Dialog(IDD_BROWSER_DIALOG), m_reapack(reapack),
-    m_loadState(Init), m_currentIndex(-1)
+    m_loadState(Init), m_currentIndex(-1), m_bleedingEdge(false)
 {
 }
 
@@ -579,7 +587,7 @@ void Browser::setFilter(const string &newFilter)
 void Browser::populate(const vector<IndexPtr> &indexes)
 {
   try {
-    Registry reg(Path::prefixRoot(Path::REGISTRY));
+    Registry reg(Path::prefixRoot(Path::REGISTRY), Registry::ReadOnly);
 
     // keep previous entries in memory a bit longer for #transferActions
     vector<Entry> oldEntries;
@@ -593,16 +601,48 @@ void Browser::populate(const vector<IndexPtr> &indexes)
     m_visibleEntries.clear();
 
     for(const IndexPtr &index : indexes) {
-      for(const Package *pkg : index->packages())
-        m_entries.push_back(makeEntry(pkg, reg.getEntry(pkg), index));
+      const vector<Registry::Entry> &regEntries = reg.getEntries(index->name());
+      const Registry::EntryMap entryMap(regEntries);
+      const unordered_set<Registry::Entry> installed(
+        regEntries.begin(), regEntries.end());
+      const auto &reusable = reusableEntries(index, oldEntries);
+
+      // uninstalled entries are still valid if no package was installed since
+      size_t known = 0;
+      for(const auto &pair : reusable) {
+        if(installed.count(pair.second->regEntry))
+          known++;
+      }
+
+      for(const Package *pkg : index->packages()) {
+        const auto it = reusable.find(pkg);
+
+        if(it != reusable.end()) {
+          const Entry &old = *it->second;
+          const auto regIt = installed.find(old.regEntry);
+
+          if(regIt != installed.end() && SameState(*regIt, old.regEntry)) {
+            m_entries.push_back(reuseEntry(old, pkg, *regIt, index));
+            continue;
+          }
+          else if(!old.regEntry && known == installed.size()) {
+            m_entries.push_back(reuseEntry(old, pkg, old.regEntry, index));
+            continue;
+          }
+        }
+
+        m_entries.push_back(makeEntry(pkg, entryMap.find(pkg), index));
+      }
 
       // obsolete packages
-      for(const Registry::Entry &regEntry : reg.getEntries(index->name())) {
+      for(const Registry::Entry &regEntry : regEntries) {
         if(!index->find(regEntry.category, regEntry.package))
           m_entries.push_back({InstalledFlag | ObsoleteFlag, regEntry, index});
       }
     }
 
+    m_bleedingEdge = m_reapack->config()->install.bleedingEdge;
+
     transferActions();
     fillList();
   }
@@ -621,6 +661,42 @@ void Browser::populate(const vector<IndexPtr> &indexes)
     show();
 }
 
+auto Browser::reusableEntries(const IndexPtr &index,
+  const vector<Entry> &oldEntries) const
+  -> unordered_map<const Package *, const Entry *>
+{
+  unordered_map<const Package *, const Entry *> previous, reusable;
+
+  // the latest version of each entry depends on this setting
+  if(m_bleedingEdge != m_reapack->config()->install.bleedingEdge)
+    return reusable;
+
+  const Index *oldIndex = nullptr;
+
+  for(const Entry &entry : oldEntries) {
+    if(entry.package && (entry.index == index ||
+        entry.index->name() == index->name())) {
+      previous.emplace(entry.package, &entry);
+      oldIndex = entry.index.get();
+    }
+  }
+
+  // the old index is kept when the contents of the repository didn't change
+  if(!oldIndex || oldIndex == index.get())
+    return previous;
+
+  // otherwise only the packages that are identical in both keep their entry
+  const IndexDiff diff(oldIndex, index.get());
+
+  for(const auto &pair : diff.unchanged()) {
+    const auto it = previous.find(pair.first);
+    if(it != previous.end())
+      reusable.emplace(pair.second, it->second);
+  }
+
+  return reusable;
+}
+
 void Browser::transferActions()
 {
   list<Entry *> oldActions;
@@ -682,6 +758,30 @@ auto Browser::makeEntry(const Package *pkg,
   return {flags, regEntry, index, pkg, latest, current};
 }
 
+auto Browser::reuseEntry(const Entry &old, const Package *pkg,
+    const Registry::Entry &regEntry, const IndexPtr &index) const -> Entry
+{
+  Entry entry = old;
+  entry.regEntry = regEntry;
+  entry.index = index;
+
+  // point to the identical package and versions of the new index
+  if(entry.package != pkg) {
+    entry.package = pkg;
+
+    if(old.latest)
+      entry.latest = pkg->findVersion(old.latest->name());
+    if(old.current)
+      entry.current = pkg->findVersion(old.current->name());
+  }
+
+  // pending actions are restored by #transferActions
+  entry.target = boost::none;
+  entry.pin = boost::none;
+
+  return entry;
+}
+
 void Browser::fillList()
 {
   InhibitControl freeze(m_list);
@@ -919,7 +1019,7 @@ void Browser::installVersion(const int index, const size_t verIndex)
   if(!entry)
     return;
 
-  const auto versions = entry->package->versions();
+  const auto &versions = entry->package->versions();
 
   if(verIndex >= versions.size())
     return;
@@ -1103,12 +1203,24 @@ bool Browser::apply()
   return true;
 }
 
-auto Browser::Entry::hash() const -> Hash
+bool Browser::Entry::operator==(const Entry &o) const
 {
-  if(package) {
-    return make_tuple(package->category()->index()->name(),
-      package->category()->name(), package->name());
-  }
-  else
-    return make_tuple(regEntry.remote, regEntry.category, regEntry.package);
+  // packages of the same index are never duplicated
+  if(package && o.package && index == o.index)
+    return package == o.package;
+
+  const auto names = [](const Entry &e) {
+    const Package *pkg = e.package;
+
+    if(pkg) {
+      return forward_as_tuple(pkg->category()->index()->name(),
+        pkg->category()->name(), pkg->name());
+    }
+    else {
+      return forward_as_tuple(e.regEntry.remote,
+        e.regEntry.category, e.regEntry.package);
+    }
+  };
+
+  return names(*this) == names(o);
 }
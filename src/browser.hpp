@@ -30,6 +30,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class Index;
@@ -63,8 +64,6 @@ private:
   };
 
   struct Entry {
-    typedef std::tuple<std::string, std::string, std::string> Hash;
-
     int flags;
     Registry::Entry regEntry;
     IndexPtr index;
@@ -75,10 +74,9 @@ private:
     boost::optional<const Version *> target;
     boost::optional<bool> pin;
 
-    Hash hash() const;
     bool test(Flag f) const { return (flags & f) != 0; }
     bool canPin() const { return target ? *target != nullptr : test(InstalledFlag); }
-    bool operator==(const Entry &o) const { return hash() == o.hash(); }
+    bool operator==(const Entry &) const;
   };
 
   enum Column {
@@ -109,10 +107,14 @@ private:
   };
 
   Entry makeEntry(const Package *, const Registry::Entry &, const IndexPtr &) const;
+  Entry reuseEntry(const Entry &, const Package *,
+    const Registry::Entry &, const IndexPtr &) const;
 
   void onSelection();
   bool fillContextMenu(Menu &, int index);
   void populate(const std::vector<IndexPtr> &);
+  std::unordered_map<const Package *, const Entry *> reusableEntries(
+    const IndexPtr &, const std::vector<Entry> &oldEntries) const;
   void transferActions();
   bool match(const Entry &) const;
   void updateFilter();
@@ -150,6 +152,7 @@ private:
   ReaPack *m_reapack;
   LoadState m_loadState;
   int m_currentIndex;
+  bool m_bleedingEdge;
 
   Filter m_filter;
   boost::optional<Package::Type> m_typeFilter;
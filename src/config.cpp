@@ -34,6 +34,8 @@ static const auto_char *INSTALL_GRP = AUTO_STR("install");
 static const auto_char *AUTOINSTALL_KEY = AUTO_STR("autoinstall");
 static const auto_char *PRERELEASES_KEY = AUTO_STR("prereleases");
 static const auto_char *PROMPTOBSOLETE_KEY = AUTO_STR("promptobsolete");
+static const auto_char *SYNCFILES_KEY = AUTO_STR("syncfiles");
+static const auto_char *SHAREFILES_KEY = AUTO_STR("sharefiles");
 
 static const auto_char *ABOUT_GRP = AUTO_STR("about");
 static const auto_char *MANAGER_GRP = AUTO_STR("manager");
@@ -67,7 +69,7 @@ Config::Config()
 void Config::resetOptions()
 {
   browser = {true};
-  install = {false, false, true};
+  install = {false, false, true, true, false};
   network = {"", true};
   windowState = {};
 }
@@ -142,6 +144,10 @@ void Config::read(const Path &path)
     PRERELEASES_KEY, install.bleedingEdge) > 0;
   install.promptObsolete = getUInt(INSTALL_GRP,
     PROMPTOBSOLETE_KEY, install.promptObsolete) > 0;
+  install.syncFiles = getUInt(INSTALL_GRP,
+    SYNCFILES_KEY, install.syncFiles) > 0;
+  install.shareFiles = getUInt(INSTALL_GRP,
+    SHAREFILES_KEY, install.shareFiles) > 0;
 
   browser.showDescs = getUInt(BROWSER_GRP,
     SHOWDESCS_KEY, browser.showDescs) > 0;
@@ -166,6 +172,8 @@ void Config::write()
   setUInt(INSTALL_GRP, AUTOINSTALL_KEY, install.autoInstall);
   setUInt(INSTALL_GRP, PRERELEASES_KEY, install.bleedingEdge);
   setUInt(INSTALL_GRP, PROMPTOBSOLETE_KEY, install.promptObsolete);
+  setUInt(INSTALL_GRP, SYNCFILES_KEY, install.syncFiles);
+  setUInt(INSTALL_GRP, SHAREFILES_KEY, install.shareFiles);
 
   setUInt(BROWSER_GRP, SHOWDESCS_KEY, browser.showDescs);
 
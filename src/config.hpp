@@ -39,6 +39,8 @@ struct InstallOpts {
   bool autoInstall;
   bool bleedingEdge;
   bool promptObsolete;
+  bool syncFiles;
+  bool shareFiles;
 };
 
 struct NetworkOpts {
@@ -19,19 +19,27 @@
 
 #include "errors.hpp"
 
+#include <cassert>
 #include <cinttypes>
 #include <sqlite3.h>
 
 using namespace std;
 
-Database::Database(const string &filename)
+static const size_t CACHE_SIZE = 16;
+
+Database::Database(const string &filename, const Mode mode)
 {
   const char *file = ":memory:";
+  int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
 
-  if(!filename.empty())
+  if(!filename.empty()) {
     file = filename.c_str();
 
-  if(sqlite3_open(file, &m_db)) {
+    if(mode == ReadOnly)
+      flags = SQLITE_OPEN_READONLY;
+  }
+
+  if(sqlite3_open_v2(file, &m_db, flags, nullptr)) {
     const auto &error = lastError();
     sqlite3_close(m_db);
 
@@ -46,6 +54,8 @@ Database::~Database()
   for(Statement *stmt : m_statements)
     delete stmt;
 
+  m_cache.clear();
+
   sqlite3_close(m_db);
 }
 
@@ -57,6 +67,30 @@ Statement *Database::prepare(const char *sql)
   return stmt;
 }
 
+StatementPtr Database::cached(const string &sql) const
+{
+  // the returned handle keeps the statement alive even if CACHE_SIZE other
+  // queries are cached after it (it is then finalized with the handle)
+  const auto it = m_cacheIndex.find(sql);
+
+  if(it != m_cacheIndex.end()) {
+    m_cache.splice(m_cache.begin(), m_cache, it->second);
+    return m_cache.front().second;
+  }
+
+  const StatementPtr stmt = make_shared<Statement>(sql.c_str(), this);
+
+  if(m_cache.size() >= CACHE_SIZE) {
+    m_cacheIndex.erase(m_cache.back().first);
+    m_cache.pop_back();
+  }
+
+  m_cache.emplace_front(sql, stmt);
+  m_cacheIndex[sql] = m_cache.begin();
+
+  return stmt;
+}
+
 void Database::exec(const char *sql)
 {
   if(sqlite3_exec(m_db, sql, nullptr, nullptr, nullptr) != SQLITE_OK)
@@ -77,9 +111,9 @@ auto Database::version() const -> Version
 {
   int32_t version = 0;
 
-  Statement stmt("PRAGMA user_version", this);
-  stmt.exec([&] {
-    version = static_cast<int32_t>(stmt.intColumn(0));
+  const StatementPtr &stmt = cached("PRAGMA user_version");
+  stmt->exec([&] {
+    version = static_cast<int32_t>(stmt->intColumn(0));
     return false;
   });
 
@@ -105,12 +139,56 @@ void Database::begin()
   // IMMEDIATE -> don't wait until the first query to aquire a lock
   // but still allow new read-only connections (unlike EXCLUSIVE)
   // while preventing new transactions to be made as long as it's active
-  exec("BEGIN IMMEDIATE TRANSACTION");
+  cached("BEGIN IMMEDIATE TRANSACTION")->exec();
+}
+
+void Database::beginSnapshot()
+{
+  // DEFERRED -> no lock is taken: in WAL mode every read done until the
+  // transaction ends sees the database as of the first query, without
+  // blocking (or being blocked by) the writer
+  cached("BEGIN DEFERRED TRANSACTION")->exec();
 }
 
 void Database::commit()
 {
-  exec("COMMIT");
+  cached("COMMIT")->exec();
+}
+
+void Database::loadInMemory()
+{
+  // continue on a private writable copy of the database, leaving the file
+  // untouched (prepared statements would still use the previous connection)
+  assert(m_statements.empty());
+
+  sqlite3 *memory;
+
+  if(sqlite3_open(":memory:", &memory)) {
+    const reapack_error error(sqlite3_errmsg(memory));
+    sqlite3_close(memory);
+
+    throw error;
+  }
+
+  if(sqlite3_backup *backup = sqlite3_backup_init(memory, "main", m_db, "main")) {
+    sqlite3_backup_step(backup, -1);
+    sqlite3_backup_finish(backup);
+  }
+
+  if(sqlite3_errcode(memory) != SQLITE_OK) {
+    const reapack_error error(sqlite3_errmsg(memory));
+    sqlite3_close(memory);
+
+    throw error;
+  }
+
+  m_cacheIndex.clear();
+  m_cache.clear();
+
+  sqlite3_close(m_db);
+  m_db = memory;
+
+  exec("PRAGMA foreign_keys = 1");
 }
 
 Statement::Statement(const char *sql, const Database *db)
@@ -161,6 +239,11 @@ void Statement::exec(const ExecCallback &callback)
   }
 }
 
+bool Statement::isNull(const int index) const
+{
+  return sqlite3_column_type(m_stmt, index) == SQLITE_NULL;
+}
+
 int64_t Statement::intColumn(const int index) const
 {
   return sqlite3_column_int64(m_stmt, index);
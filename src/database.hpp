@@ -20,7 +20,10 @@
 
 #include <cstdint>
 #include <functional>
+#include <list>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class reapack_error;
@@ -29,6 +32,7 @@ struct sqlite3;
 struct sqlite3_stmt;
 
 class Statement;
+typedef std::shared_ptr<Statement> StatementPtr;
 
 class Database {
 public:
@@ -44,25 +48,40 @@ public:
     }
   };
 
-  Database(const std::string &filename = std::string());
+  enum Mode {
+    ReadWrite,
+    ReadOnly, // in-memory databases are always writable
+  };
+
+  Database(const std::string &filename = std::string(), Mode = ReadWrite);
   ~Database();
 
   Statement *prepare(const char *sql);
+  StatementPtr cached(const std::string &sql) const;
   void exec(const char *sql);
   int64_t lastInsertId() const;
   Version version() const;
   void setVersion(const Version &);
   int errorCode() const;
   void begin();
+  void beginSnapshot();
   void commit();
+  void loadInMemory();
 
 private:
   friend Statement;
 
+  typedef std::pair<std::string, StatementPtr> CacheEntry;
+  typedef std::list<CacheEntry> Cache;
+
   reapack_error lastError() const;
 
   sqlite3 *m_db;
   std::vector<Statement *> m_statements;
+
+  // most recently used first
+  mutable Cache m_cache;
+  mutable std::unordered_map<std::string, Cache::iterator> m_cacheIndex;
 };
 
 class Statement {
@@ -77,6 +96,7 @@ public:
   void exec();
   void exec(const ExecCallback &);
 
+  bool isNull(int index) const;
   int64_t intColumn(int index) const;
   bool boolColumn(int index) const { return intColumn(index) != 0; }
   std::string stringColumn(int index) const;
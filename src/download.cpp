@@ -20,6 +20,7 @@
 #include "filesystem.hpp"
 #include "reapack.hpp"
 
+#include <boost/algorithm/string.hpp>
 #include <boost/format.hpp>
 
 #include <reaper_plugin_functions.h>
@@ -97,6 +98,36 @@ size_t Download::WriteData(char *data, size_t rawsize, size_t nmemb, void *ptr)
   return size;
 }
 
+size_t Download::ReadHeader(char *data, size_t rawsize, size_t nmemb, void *ptr)
+{
+  namespace ba = boost::algorithm;
+
+  const size_t size = rawsize * nmemb;
+  Download *dl = static_cast<Download *>(ptr);
+
+  string line(data, size);
+  ba::trim(line);
+
+  if(ba::istarts_with(line, "HTTP/")) {
+    // a new response (eg. after a redirection)
+    dl->m_etag.clear();
+    dl->m_lastModified.clear();
+  }
+  else if(ba::istarts_with(line, "ETag:"))
+    dl->m_etag = ba::trim_copy(line.substr(5));
+  else if(ba::istarts_with(line, "Last-Modified:"))
+    dl->m_lastModified = ba::trim_copy(line.substr(14));
+  else if(line.empty()) {
+    // end of the headers, before any of the body is written:
+    // weak entity tags cannot be used in If-Range
+    const bool strong = !dl->m_etag.empty() &&
+      !ba::starts_with(dl->m_etag, "W/");
+    dl->saveValidator(strong ? dl->m_etag : dl->m_lastModified);
+  }
+
+  return size;
+}
+
 int Download::UpdateProgress(void *ptr, const double, const double,
     const double, const double)
 {
@@ -104,7 +135,7 @@ int Download::UpdateProgress(void *ptr, const double, const double,
 }
 
 Download::Download(const string &url, const NetworkOpts &opts, const int flags)
-  : m_url(url), m_opts(opts), m_flags(flags)
+  : m_url(url), m_opts(opts), m_flags(flags), m_resumeFrom(0)
 {
 }
 
@@ -129,6 +160,12 @@ void Download::run(DownloadContext *ctx)
 
   ThreadNotifier::get()->notify({this, Running});
 
+  // the bytes already received are only kept if the server can tell whether
+  // the file changed since (otherwise they would be joined to another file)
+  string ifRange;
+  if(m_resumeFrom && (ifRange = loadValidator()).empty())
+    m_resumeFrom = 0;
+
   ostream *stream = openStream();
   if(!stream)
     return;
@@ -143,15 +180,46 @@ void Download::run(DownloadContext *ctx)
   curl_easy_setopt(ctx->m_curl, CURLOPT_WRITEFUNCTION, WriteData);
   curl_easy_setopt(ctx->m_curl, CURLOPT_WRITEDATA, stream);
 
-  curl_slist *headers = nullptr;
-  if(has(Download::NoCacheFlag))
-    headers = curl_slist_append(headers, "Cache-Control: no-cache");
+  curl_easy_setopt(ctx->m_curl, CURLOPT_HEADERFUNCTION, ReadHeader);
+  curl_easy_setopt(ctx->m_curl, CURLOPT_HEADERDATA, this);
+
+  curl_slist *headers = makeHeaders(m_resumeFrom ? ifRange : string());
   curl_easy_setopt(ctx->m_curl, CURLOPT_HTTPHEADER, headers);
 
   char errbuf[CURL_ERROR_SIZE] = "No error message";
   curl_easy_setopt(ctx->m_curl, CURLOPT_ERRORBUFFER, errbuf);
 
-  const CURLcode res = curl_easy_perform(ctx->m_curl);
+  // byte ranges apply to the encoded body, a resumed download must not
+  // be compressed by the server
+  curl_easy_setopt(ctx->m_curl, CURLOPT_ACCEPT_ENCODING,
+    m_resumeFrom ? nullptr : "");
+  curl_easy_setopt(ctx->m_curl, CURLOPT_RESUME_FROM_LARGE,
+    static_cast<curl_off_t>(m_resumeFrom));
+
+  CURLcode res = curl_easy_perform(ctx->m_curl);
+
+  if(m_resumeFrom && !aborted() && rangeRejected(ctx, res)) {
+    // the server cannot resume (or the file changed), start over
+    closeStream();
+    m_resumeFrom = 0;
+
+    curl_slist_free_all(headers);
+    headers = makeHeaders({});
+    curl_easy_setopt(ctx->m_curl, CURLOPT_HTTPHEADER, headers);
+
+    if(!(stream = openStream())) {
+      curl_slist_free_all(headers);
+      return;
+    }
+
+    curl_easy_setopt(ctx->m_curl, CURLOPT_WRITEDATA, stream);
+    curl_easy_setopt(ctx->m_curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(ctx->m_curl, CURLOPT_RESUME_FROM_LARGE,
+      static_cast<curl_off_t>(0));
+
+    res = curl_easy_perform(ctx->m_curl);
+  }
+
   closeStream();
 
   if(aborted())
@@ -166,6 +234,34 @@ void Download::run(DownloadContext *ctx)
   curl_slist_free_all(headers);
 }
 
+curl_slist *Download::makeHeaders(const string &ifRange) const
+{
+  curl_slist *headers = nullptr;
+
+  if(has(Download::NoCacheFlag))
+    headers = curl_slist_append(headers, "Cache-Control: no-cache");
+
+  // the server sends the whole file (200) instead of the requested range
+  // if it changed since the partial download was started
+  if(!ifRange.empty())
+    headers = curl_slist_append(headers, ("If-Range: " + ifRange).c_str());
+
+  return headers;
+}
+
+bool Download::rangeRejected(DownloadContext *ctx, const CURLcode res) const
+{
+  long status = 0;
+  curl_easy_getinfo(ctx->m_curl, CURLINFO_RESPONSE_CODE, &status);
+
+  // CURLE_RANGE_ERROR: the whole file was sent instead of the requested part
+  // 200: same, but curl considered it complete as it has the partial size
+  // 416: the partial file is not smaller than the one on the server anymore
+  return res == CURLE_RANGE_ERROR ||
+    (res == CURLE_OK && status == 200) ||
+    (res == CURLE_HTTP_RETURNED_ERROR && status == 416);
+}
+
 MemoryDownload::MemoryDownload(const string &url, const NetworkOpts &opts, int flags)
   : Download(url, opts, flags)
 {
@@ -181,6 +277,8 @@ FileDownload::FileDownload(const Path &target, const string &url,
 
 bool FileDownload::save()
 {
+  FS::remove(m_path.validator());
+
   if(state() == Success)
     return FS::rename(m_path);
   else
@@ -189,7 +287,8 @@ bool FileDownload::save()
 
 ostream *FileDownload::openStream()
 {
-  if(FS::open(m_stream, m_path.temp()))
+  // keep the bytes already received by an interrupted download
+  if(FS::open(m_stream, m_path.temp(), resumeFrom() > 0))
     return &m_stream;
 
   finish(Failure, {FS::lastError(), m_path.temp().join()});
@@ -200,3 +299,23 @@ void FileDownload::closeStream()
 {
   m_stream.close();
 }
+
+string FileDownload::loadValidator() const
+{
+  ifstream stream;
+  string validator;
+
+  if(FS::open(stream, m_path.validator()))
+    getline(stream, validator);
+
+  return validator;
+}
+
+void FileDownload::saveValidator(const string &validator)
+{
+  // written before the body so that it's there if the download is interrupted
+  if(validator.empty())
+    FS::remove(m_path.validator());
+  else
+    FS::write(m_path.validator(), validator);
+}
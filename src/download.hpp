@@ -47,23 +47,36 @@ public:
 
   void setName(const std::string &);
   const std::string &url() const { return m_url; }
+  void setResumeFrom(int64_t offset) { m_resumeFrom = offset; }
   void start();
 
   bool concurrent() const override { return true; }
   void run(DownloadContext *) override;
 
+protected:
+  int64_t resumeFrom() const { return m_resumeFrom; }
+
 private:
   virtual std::ostream *openStream() = 0;
   virtual void closeStream() {}
+  // ETag or Last-Modified date of the file being received
+  virtual std::string loadValidator() const { return {}; }
+  virtual void saveValidator(const std::string &) {}
 
 private:
   bool has(Flag f) const { return (m_flags & f) != 0; }
+  curl_slist *makeHeaders(const std::string &ifRange) const;
+  bool rangeRejected(DownloadContext *, CURLcode) const;
   static size_t WriteData(char *, size_t, size_t, void *);
+  static size_t ReadHeader(char *, size_t, size_t, void *);
   static int UpdateProgress(void *, double, double, double, double);
 
   std::string m_url;
   NetworkOpts m_opts;
   int m_flags;
+  int64_t m_resumeFrom;
+  std::string m_etag;
+  std::string m_lastModified;
 };
 
 class MemoryDownload : public Download {
@@ -92,6 +105,9 @@ protected:
   void closeStream() override;
 
 private:
+  std::string loadValidator() const override;
+  void saveValidator(const std::string &) override;
+
   TempPath m_path;
   std::ofstream m_stream;
 };
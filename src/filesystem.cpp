@@ -26,9 +26,13 @@
 #include <sys/stat.h>
 
 #include <reaper_plugin_functions.h>
+#include <zlib/zlib.h>
 
 #ifdef _WIN32
 #include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 using namespace std;
@@ -53,12 +57,13 @@ bool FS::open(ifstream &stream, const Path &path)
   return stream.good();
 }
 
-bool FS::open(ofstream &stream, const Path &path)
+bool FS::open(ofstream &stream, const Path &path, const bool append)
 {
   mkdir(path.dirname());
 
   const Path &fullPath = Path::prefixRoot(path);
-  stream.open(make_autostring(fullPath.join()), ios_base::binary);
+  stream.open(make_autostring(fullPath.join()),
+    append ? ios_base::binary | ios_base::app : ios_base::binary);
   return stream.good();
 }
 
@@ -96,6 +101,21 @@ bool FS::rename(const Path &from, const Path &to)
 #endif
 }
 
+bool FS::link(const Path &from, const Path &to)
+{
+  mkdir(to.dirname());
+
+  const string &fullFrom = Path::prefixRoot(from).join();
+  const string &fullTo = Path::prefixRoot(to).join();
+
+#ifdef _WIN32
+  return CreateHardLink(make_autostring(fullTo).c_str(),
+    make_autostring(fullFrom).c_str(), nullptr) != 0;
+#else
+  return !::link(fullFrom.c_str(), fullTo.c_str());
+#endif
+}
+
 bool FS::remove(const Path &path)
 {
   const auto_string &fullPath =
@@ -143,26 +163,113 @@ bool FS::removeRecursive(const Path &file)
 }
 
 bool FS::mtime(const Path &path, time_t *time)
+{
+  int64_t size;
+  return stat(path, &size, time);
+}
+
+bool FS::stat(const Path &path, int64_t *size, time_t *time)
 {
   const Path &fullPath = Path::prefixRoot(path);
 
 #ifdef _WIN32
-  struct _stat st;
+  struct _stat64 st;
 
-  if(_wstat(make_autostring(fullPath.join()).c_str(), &st))
+  if(_wstat64(make_autostring(fullPath.join()).c_str(), &st))
     return false;
 #else
   struct stat st;
 
-  if(stat(fullPath.join().c_str(), &st))
+  if(::stat(fullPath.join().c_str(), &st))
     return false;
 #endif
 
+  *size = st.st_size;
   *time = st.st_mtime;
 
   return true;
 }
 
+bool FS::checksum(const Path &path, uint32_t *crc)
+{
+  FILE *file = open(path);
+
+  if(!file)
+    return false;
+
+  uLong value = crc32(0L, Z_NULL, 0);
+
+  char buffer[16384];
+  size_t length;
+
+  while((length = fread(buffer, 1, sizeof(buffer), file))) {
+    value = crc32(value, reinterpret_cast<const Bytef *>(buffer),
+      static_cast<uInt>(length));
+  }
+
+  const bool success = !ferror(file);
+  fclose(file);
+
+  *crc = static_cast<uint32_t>(value);
+
+  return success;
+}
+
+bool FS::sync(const vector<Path> &paths)
+{
+  bool success = true;
+
+#ifdef _WIN32
+  for(const Path &path : paths) {
+    const auto_string &fullPath =
+      make_autostring(Path::prefixRoot(path).join());
+
+    // NTFS journals renames, only the contents of files need flushing
+    const DWORD attributes = GetFileAttributes(fullPath.c_str());
+    if(attributes != INVALID_FILE_ATTRIBUTES
+        && attributes & FILE_ATTRIBUTE_DIRECTORY)
+      continue;
+
+    HANDLE file = CreateFile(fullPath.c_str(), GENERIC_WRITE,
+      FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
+
+    if(file == INVALID_HANDLE_VALUE) {
+      success = false;
+      continue;
+    }
+
+    success = FlushFileBuffers(file) && success;
+    CloseHandle(file);
+  }
+#else
+  for(const Path &path : paths) {
+    const string &fullPath = Path::prefixRoot(path).join();
+    const int fd = ::open(fullPath.c_str(), O_RDONLY);
+
+    if(fd < 0) {
+      success = false;
+      continue;
+    }
+
+#if defined(__APPLE__)
+    // fsync only hands the data to the drive, which may keep it in its cache
+    // (F_FULLFSYNC is unsupported by some filesystems, eg. network shares)
+    if(fcntl(fd, F_FULLFSYNC) == -1)
+      success = !fsync(fd) && success;
+#elif defined(__linux__)
+    // the modification time of a new file doesn't need to be flushed
+    success = !fdatasync(fd) && success;
+#else
+    success = !fsync(fd) && success;
+#endif
+
+    close(fd);
+  }
+#endif
+
+  return success;
+}
+
 bool FS::exists(const Path &path)
 {
   const Path &fullPath = Path::prefixRoot(path);
@@ -18,7 +18,9 @@
 #ifndef REAPACK_FILESYSTEM_HPP
 #define REAPACK_FILESYSTEM_HPP
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 class Path;
 class TempPath;
@@ -26,13 +28,17 @@ class TempPath;
 namespace FS {
   FILE *open(const Path &);
   bool open(std::ifstream &, const Path &);
-  bool open(std::ofstream &, const Path &);
+  bool open(std::ofstream &, const Path &, bool append = false);
   bool write(const Path &, const std::string &);
   bool rename(const TempPath &);
   bool rename(const Path &, const Path &);
+  bool link(const Path &from, const Path &to);
   bool remove(const Path &);
   bool removeRecursive(const Path &);
   bool mtime(const Path &, time_t *);
+  bool stat(const Path &, int64_t *size, time_t *mtime);
+  bool checksum(const Path &, uint32_t *);
+  bool sync(const std::vector<Path> &);
   bool exists(const Path &);
   void mkdir(const Path &);
 
@@ -23,6 +23,8 @@
 #include "path.hpp"
 #include "remote.hpp"
 
+#include <algorithm>
+#include <list>
 #include <WDL/tinyxml/tinyxml.h>
 
 using namespace std;
@@ -86,12 +88,6 @@ Index::Index(const string &name)
 {
 }
 
-Index::~Index()
-{
-  for(const Category *cat : m_categories)
-    delete cat;
-}
-
 void Index::setName(const string &newName)
 {
   if(!m_name.empty())
@@ -137,21 +133,15 @@ const Package *Index::find(const string &catName, const string &pkgName) const
 }
 
 Category::Category(const string &name, const Index *ri)
-  : m_index(ri), m_name(name)
+  : m_index(ri), m_name(name, Index::stringsFor(ri))
 {
-  if(m_name.empty())
+  if(name.empty())
     throw reapack_error("empty category name");
 }
 
-Category::~Category()
-{
-  for(const Package *pack : m_packages)
-    delete pack;
-}
-
 string Category::fullName() const
 {
-  return m_index ? m_index->name() + "/" + m_name : m_name;
+  return m_index ? m_index->name() + "/" + name() : name();
 }
 
 bool Category::addPackage(const Package *pkg)
@@ -176,3 +166,203 @@ const Package *Category::package(const string &name) const
   else
     return package(it->second);
 }
+
+static bool SameMetadata(const Metadata *a, const Metadata *b)
+{
+  if(a->about() != b->about() || a->links().size() != b->links().size())
+    return false;
+
+  return equal(a->links().begin(), a->links().end(), b->links().begin(),
+    [] (const auto &l, const auto &r) {
+      return l.first == r.first &&
+        l.second.name == r.second.name && l.second.url == r.second.url;
+    });
+}
+
+static bool SameSource(const Source *a, const Source *b)
+{
+  return a->platform() == b->platform() &&
+    a->typeOverride() == b->typeOverride() &&
+    a->sections() == b->sections() &&
+    a->file() == b->file() && a->url() == b->url();
+}
+
+static bool SameVersion(const Version *a, const Version *b)
+{
+  if(a->name().toString() != b->name().toString() ||
+      a->author() != b->author() || a->time() != b->time() ||
+      a->changelog() != b->changelog())
+    return false;
+
+  const auto &sa = a->sources(), &sb = b->sources();
+  return sa.size() == sb.size() &&
+    equal(sa.begin(), sa.end(), sb.begin(), &SameSource);
+}
+
+static bool SamePackage(const Package *a, const Package *b)
+{
+  if(a->type() != b->type() || a->description() != b->description() ||
+      !SameMetadata(a->metadata(), b->metadata()))
+    return false;
+
+  const auto &va = a->versions(), &vb = b->versions();
+  return va.size() == vb.size() &&
+    equal(va.begin(), va.end(), vb.begin(), &SameVersion);
+}
+
+IndexDiff::IndexDiff(const Index *before, const Index *after)
+  : m_metadataChanged(!SameMetadata(before->metadata(), after->metadata()))
+{
+  for(const Category *cat : after->categories()) {
+    if(!before->category(cat->name()))
+      m_addedCategories.push_back(cat);
+  }
+
+  for(const Category *cat : before->categories()) {
+    if(!after->category(cat->name()))
+      m_removedCategories.push_back(cat);
+  }
+
+  for(const Package *pkg : after->packages()) {
+    const Package *old = before->find(pkg->category()->name(), pkg->name());
+
+    if(!old)
+      m_added.push_back(pkg);
+    else if(!SamePackage(old, pkg))
+      m_changed.push_back({old, pkg});
+    else
+      m_unchanged.push_back({old, pkg});
+  }
+
+  for(const Package *pkg : before->packages()) {
+    if(!after->find(pkg->category()->name(), pkg->name()))
+      m_removed.push_back(pkg);
+  }
+}
+
+bool IndexDiff::empty() const
+{
+  // added or removed categories always come with added or removed packages
+  return m_added.empty() && m_removed.empty() && m_changed.empty() &&
+    !m_metadataChanged;
+}
+
+// Cached indexes can be found for as long as something else still uses them.
+// Only the few most recently used ones are kept alive by the cache itself.
+static const size_t KEEP_ALIVE = 4;
+
+typedef pair<IndexCache::Stamp, weak_ptr<const Index>> CacheEntry;
+
+static unordered_map<string, CacheEntry> &IndexCacheEntries()
+{
+  static unordered_map<string, CacheEntry> entries;
+  return entries;
+}
+
+static list<IndexPtr> &IndexCacheRecent()
+{
+  static list<IndexPtr> recent; // most recently used first
+  return recent;
+}
+
+static void KeepAlive(const IndexPtr &ri)
+{
+  auto &recent = IndexCacheRecent();
+  recent.remove(ri);
+  recent.push_front(ri);
+
+  if(recent.size() > KEEP_ALIVE)
+    recent.pop_back();
+}
+
+static void Forget(unordered_map<string, CacheEntry>::iterator it)
+{
+  if(const IndexPtr &ri = it->second.second.lock())
+    IndexCacheRecent().remove(ri);
+
+  IndexCacheEntries().erase(it);
+}
+
+bool IndexCache::stamp(const string &name, Stamp *stamp)
+{
+  return FS::stat(Index::pathFor(name), &stamp->size, &stamp->mtime);
+}
+
+IndexPtr IndexCache::find(const string &name)
+{
+  auto &entries = IndexCacheEntries();
+  const auto it = entries.find(name);
+
+  if(it == entries.end())
+    return nullptr;
+
+  Stamp current;
+  const IndexPtr &ri = it->second.second.lock();
+  if(ri && stamp(name, &current) && current == it->second.first) {
+    KeepAlive(ri);
+    return ri;
+  }
+
+  Forget(it);
+  return nullptr;
+}
+
+void IndexCache::insert(const string &name,
+  const Stamp &stamp, const IndexPtr &ri)
+{
+  auto &entries = IndexCacheEntries();
+
+  // drop the indexes nobody uses anymore
+  for(auto it = entries.begin(); it != entries.end();) {
+    if(it->first == name || it->second.second.expired())
+      Forget(it++);
+    else
+      it++;
+  }
+
+  entries.emplace(name, CacheEntry{stamp, ri});
+  KeepAlive(ri);
+}
+
+void IndexCache::invalidate(const string &name)
+{
+  auto &entries = IndexCacheEntries();
+  const auto it = entries.find(name);
+
+  if(it != entries.end())
+    Forget(it);
+}
+
+void IndexCache::clear()
+{
+  IndexCacheEntries().clear();
+  IndexCacheRecent().clear();
+}
+
+IndexLoader::IndexLoader(const string &name)
+  : m_name(name), m_stamp{-1, 0}
+{
+  setSummary("Loading %s: " + name);
+}
+
+void IndexLoader::run(DownloadContext *)
+{
+  if(aborted()) {
+    finish(Aborted, {"cancelled", m_name});
+    return;
+  }
+
+  ThreadNotifier::get()->notify({this, Running});
+
+  try {
+    // taken before reading so a concurrent rewrite can only make it outdated
+    if(!IndexCache::stamp(m_name, &m_stamp))
+      m_stamp.size = -1;
+
+    m_index = Index::load(m_name);
+    finish(Success);
+  }
+  catch(const reapack_error &e) {
+    finish(Failure, {"Couldn't load repository: " + string(e.what()), m_name});
+  }
+}
@@ -18,15 +18,19 @@
 #ifndef REAPACK_INDEX_HPP
 #define REAPACK_INDEX_HPP
 
+#include <ctime>
 #include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "arena.hpp"
 #include "metadata.hpp"
 #include "package.hpp"
 #include "source.hpp"
+#include "stringpool.hpp"
+#include "thread.hpp"
 
 class Index;
 class Path;
@@ -42,7 +46,6 @@ public:
   static IndexPtr load(const std::string &name, const char *data = nullptr);
 
   Index(const std::string &name);
-  ~Index();
 
   void setName(const std::string &);
   const std::string &name() const { return m_name; }
@@ -50,6 +53,19 @@ public:
   Metadata *metadata() { return &m_metadata; }
   const Metadata *metadata() const { return &m_metadata; }
 
+  // Nodes never own each other. The categories, packages, versions and
+  // sources of an index loaded from a file are allocated in its arena and
+  // are all released together with the index. Those built by other means
+  // belong to whoever created them.
+  Arena *arena() { return &m_arena; }
+
+  // Strings repeated across nodes (authors, categories, file names...) are
+  // stored once. Interning does not alter the contents of the index, hence
+  // the const. Nodes without an index keep their own copies.
+  StringPool *strings() const { return &m_strings; }
+  static StringPool *stringsFor(const Index *ri)
+    { return ri ? ri->strings() : nullptr; }
+
   bool addCategory(const Category *cat);
   const auto &categories() const { return m_categories; }
   const Category *category(size_t i) const { return m_categories[i]; }
@@ -67,15 +83,18 @@ private:
   std::vector<const Package *> m_packages;
 
   std::unordered_map<std::string, size_t> m_catMap;
+  mutable StringPool m_strings;
+
+  // declared last to be destroyed first, while the rest is still valid
+  Arena m_arena;
 };
 
 class Category {
 public:
   Category(const std::string &name, const Index *);
-  ~Category();
 
   const Index *index() const { return m_index; }
-  const std::string &name() const { return m_name; }
+  const std::string &name() const { return m_name.str(); }
   std::string fullName() const;
 
   bool addPackage(const Package *pack);
@@ -86,9 +105,83 @@ public:
 private:
   const Index *m_index;
 
-  std::string m_name;
+  PooledString m_name;
   std::vector<const Package *> m_packages;
   std::unordered_map<std::string, size_t> m_pkgMap;
 };
 
+// Lists what changed between two revisions of a repository's index.
+// Packages and categories are matched by name.
+class IndexDiff {
+public:
+  typedef std::pair<const Package *, const Package *> PackagePair;
+
+  IndexDiff(const Index *before, const Index *after);
+
+  bool empty() const;
+
+  // packages from the new index
+  const auto &added() const { return m_added; }
+  // packages from the old index
+  const auto &removed() const { return m_removed; }
+  // old and new revisions of the packages
+  const auto &changed() const { return m_changed; }
+  const auto &unchanged() const { return m_unchanged; }
+
+  const auto &addedCategories() const { return m_addedCategories; }
+  const auto &removedCategories() const { return m_removedCategories; }
+  bool metadataChanged() const { return m_metadataChanged; }
+
+private:
+  std::vector<const Package *> m_added;
+  std::vector<const Package *> m_removed;
+  std::vector<PackagePair> m_changed;
+  std::vector<PackagePair> m_unchanged;
+  std::vector<const Category *> m_addedCategories;
+  std::vector<const Category *> m_removedCategories;
+  bool m_metadataChanged;
+};
+
+// Parsed indexes shared by every transaction and dialog for as long as their
+// cache file is unchanged on disk and they are still in use (or were among
+// the last few used). Only to be used from the main thread.
+class IndexCache {
+public:
+  struct Stamp {
+    int64_t size;
+    time_t mtime;
+
+    bool operator==(const Stamp &o) const
+    {
+      return size == o.size && mtime == o.mtime;
+    }
+  };
+
+  static bool stamp(const std::string &name, Stamp *);
+  static IndexPtr find(const std::string &name);
+  static void insert(const std::string &name, const Stamp &, const IndexPtr &);
+  static void invalidate(const std::string &name);
+  static void clear();
+};
+
+// Parses a cached index file in a worker thread so that large repositories
+// don't freeze the interface. The result is available from the main thread
+// once the task has finished successfully.
+class IndexLoader : public ThreadTask {
+public:
+  IndexLoader(const std::string &name);
+
+  const std::string &name() const { return m_name; }
+  const IndexPtr &index() const { return m_index; }
+  const IndexCache::Stamp &stamp() const { return m_stamp; }
+
+  bool concurrent() const override { return true; }
+  void run(DownloadContext *) override;
+
+private:
+  std::string m_name;
+  IndexPtr m_index;
+  IndexCache::Stamp m_stamp;
+};
+
 #endif
@@ -19,16 +19,15 @@
 
 #include "errors.hpp"
 
-#include <sstream>
 #include <WDL/tinyxml/tinyxml.h>
 
 using namespace std;
 
-static void LoadMetadataV1(TiXmlElement *, Metadata *);
+static void LoadMetadataV1(TiXmlElement *, Metadata *, Arena *);
 static void LoadCategoryV1(TiXmlElement *, Index *);
-static void LoadPackageV1(TiXmlElement *, Category *);
-static void LoadVersionV1(TiXmlElement *, Package *);
-static void LoadSourceV1(TiXmlElement *, Version *);
+static void LoadPackageV1(TiXmlElement *, Category *, Arena *);
+static void LoadVersionV1(TiXmlElement *, Package *, Arena *);
+static void LoadSourceV1(TiXmlElement *, Version *, Arena *);
 
 void Index::loadV1(TiXmlElement *root, Index *ri)
 {
@@ -48,16 +47,17 @@ void Index::loadV1(TiXmlElement *root, Index *ri)
   node = root->FirstChildElement("metadata");
 
   if(node)
-    LoadMetadataV1(node, ri->metadata());
+    LoadMetadataV1(node, ri->metadata(), ri->arena());
 }
 
-void LoadMetadataV1(TiXmlElement *meta, Metadata *md)
+void LoadMetadataV1(TiXmlElement *meta, Metadata *md, Arena *arena)
 {
   TiXmlElement *node = meta->FirstChildElement("description");
 
+  // large texts are only copied into strings when they are displayed
   if(node) {
     if(const char *rtf = node->GetText())
-      md->setAbout(rtf);
+      md->setAboutRef(arena->copy(rtf));
   }
 
   node = meta->FirstChildElement("link");
@@ -85,22 +85,22 @@ void LoadCategoryV1(TiXmlElement *catNode, Index *ri)
   const char *name = catNode->Attribute("name");
   if(!name) name = "";
 
-  Category *cat = new Category(name, ri);
-  unique_ptr<Category> ptr(cat);
+  Arena *arena = ri->arena();
+  Category *cat = arena->make<Category>(name, ri);
 
   TiXmlElement *packNode = catNode->FirstChildElement("reapack");
 
   while(packNode) {
-    LoadPackageV1(packNode, cat);
+    LoadPackageV1(packNode, cat, arena);
 
     packNode = packNode->NextSiblingElement("reapack");
   }
 
-  if(ri->addCategory(cat))
-    ptr.release();
+  // rejected nodes are released along with the rest of the arena
+  ri->addCategory(cat);
 }
 
-void LoadPackageV1(TiXmlElement *packNode, Category *cat)
+void LoadPackageV1(TiXmlElement *packNode, Category *cat, Arena *arena)
 {
   const char *type = packNode->Attribute("type");
   if(!type) type = "";
@@ -111,15 +111,14 @@ void LoadPackageV1(TiXmlElement *packNode, Category *cat)
   const char *desc = packNode->Attribute("desc");
   if(!desc) desc = "";
 
-  Package *pack = new Package(Package::getType(type), name, cat);
-  unique_ptr<Package> ptr(pack);
+  Package *pack = arena->make<Package>(Package::getType(type), name, cat);
 
   pack->setDescription(desc);
 
   TiXmlElement *node = packNode->FirstChildElement("version");
 
   while(node) {
-    LoadVersionV1(node, pack);
+    LoadVersionV1(node, pack, arena);
 
     node = node->NextSiblingElement("version");
   }
@@ -127,19 +126,17 @@ void LoadPackageV1(TiXmlElement *packNode, Category *cat)
   node = packNode->FirstChildElement("metadata");
 
   if(node)
-    LoadMetadataV1(node, pack->metadata());
+    LoadMetadataV1(node, pack->metadata(), arena);
 
-  if(cat->addPackage(pack))
-    ptr.release();
+  cat->addPackage(pack);
 }
 
-void LoadVersionV1(TiXmlElement *verNode, Package *pkg)
+void LoadVersionV1(TiXmlElement *verNode, Package *pkg, Arena *arena)
 {
   const char *name = verNode->Attribute("name");
   if(!name) name = "";
 
-  Version *ver = new Version(name, pkg);
-  unique_ptr<Version> ptr(ver);
+  Version *ver = arena->make<Version>(name, pkg);
 
   const char *author = verNode->Attribute("author");
   if(author) ver->setAuthor(author);
@@ -150,7 +147,7 @@ void LoadVersionV1(TiXmlElement *verNode, Package *pkg)
   TiXmlElement *node = verNode->FirstChildElement("source");
 
   while(node) {
-    LoadSourceV1(node, ver);
+    LoadSourceV1(node, ver, arena);
     node = node->NextSiblingElement("source");
   }
 
@@ -158,14 +155,13 @@ void LoadVersionV1(TiXmlElement *verNode, Package *pkg)
 
   if(node) {
     if(const char *changelog = node->GetText())
-      ver->setChangelog(changelog);
+      ver->setChangelogRef(arena->copy(changelog));
   }
 
-  if(pkg->addVersion(ver))
-    ptr.release();
+  pkg->addVersion(ver);
 }
 
-void LoadSourceV1(TiXmlElement *node, Version *ver)
+void LoadSourceV1(TiXmlElement *node, Version *ver, Arena *arena)
 {
   const char *platform = node->Attribute("platform");
   if(!platform) platform = "all";
@@ -182,19 +178,12 @@ void LoadSourceV1(TiXmlElement *node, Version *ver)
   const char *url = node->GetText();
   if(!url) url = "";
 
-  Source *src = new Source(file, url, ver);
-  unique_ptr<Source> ptr(src);
+  Source *src = arena->make<Source>(file, url, ver);
 
   src->setPlatform(platform);
   src->setTypeOverride(Package::getType(type));
 
-  int sections = 0;
-  string section;
-  istringstream mainStream(main);
-  while(getline(mainStream, section, '\x20'))
-    sections |= Source::getSection(section.c_str());
-  src->setSections(sections);
+  src->setSections(Source::getSections(main));
 
-  if(ver->addSource(src))
-    ptr.release();
+  ver->addSource(src);
 }
@@ -0,0 +1,201 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "journal.hpp"
+
+#include "filesystem.hpp"
+#include "path.hpp"
+
+#include <vector>
+
+using namespace std;
+
+// staged files of an interrupted transaction are kept this long for a
+// later one to pick up
+static const time_t MAX_AGE = 7 * 24 * 3600;
+
+Journal::Journal(const Path &path)
+  : m_db(path.join())
+{
+  // every change must survive a crash without waiting for each download
+  m_db.exec("PRAGMA journal_mode = WAL");
+  m_db.exec("PRAGMA synchronous = NORMAL");
+
+  migrate();
+
+  m_plan = m_db.prepare(
+    "INSERT OR REPLACE INTO staged(path, url, identity, planned) "
+    "VALUES(?, ?, ?, ?)");
+  m_staged = m_db.prepare(
+    "UPDATE staged SET size = ?, mtime = ?, checksum = ? WHERE path = ?");
+  m_find = m_db.prepare(
+    "SELECT url, identity, IFNULL(size, -1), IFNULL(mtime, 0), "
+    "  IFNULL(checksum, 0) "
+    "FROM staged WHERE path = ? LIMIT 1");
+  m_forget = m_db.prepare("DELETE FROM staged WHERE path = ?");
+}
+
+void Journal::migrate()
+{
+  const Database::Version version{0, 3};
+  const Database::Version &current = m_db.version();
+
+  if(current && !(current < version))
+    return;
+
+  // nothing worth migrating, staged files are only a shortcut
+  m_db.begin();
+  m_db.exec(
+    "DROP TABLE IF EXISTS staged;"
+
+    "CREATE TABLE staged ("
+    "  path TEXT PRIMARY KEY,"
+    "  url TEXT NOT NULL,"
+    "  identity TEXT NOT NULL,"
+    "  size INTEGER,"
+    "  mtime INTEGER,"
+    "  checksum INTEGER,"
+    "  planned INTEGER NOT NULL"
+    ");"
+  );
+  m_db.setVersion(version);
+  m_db.commit();
+}
+
+void Journal::plan(const TempPath &path, const string &url,
+  const string &identity)
+{
+  m_plan->bind(1, path.target().join());
+  m_plan->bind(2, url);
+  m_plan->bind(3, identity);
+  m_plan->bind(4, time(nullptr));
+  m_plan->exec();
+
+  m_owned.insert(path.target().join());
+}
+
+void Journal::staged(const TempPath &path)
+{
+  int64_t size;
+  time_t mtime;
+  uint32_t checksum;
+
+  if(!FS::stat(path.temp(), &size, &mtime) ||
+      !FS::checksum(path.temp(), &checksum))
+    return;
+
+  m_staged->bind(1, size);
+  m_staged->bind(2, mtime);
+  m_staged->bind(3, checksum);
+  m_staged->bind(4, path.target().join());
+  m_staged->exec();
+}
+
+bool Journal::find(const TempPath &path, const string &url,
+  const string &identity, int64_t *size, time_t *mtime, uint32_t *checksum)
+{
+  bool match = false;
+
+  m_find->bind(1, path.target().join());
+  m_find->exec([&] {
+    match = m_find->stringColumn(0) == url &&
+      m_find->stringColumn(1) == identity;
+    *size = m_find->intColumn(2);
+    *mtime = static_cast<time_t>(m_find->intColumn(3));
+    *checksum = static_cast<uint32_t>(m_find->intColumn(4));
+    return false;
+  });
+
+  return match;
+}
+
+bool Journal::adopt(const TempPath &path, const string &url,
+  const string &identity)
+{
+  int64_t size = -1;
+  time_t mtime = 0;
+  uint32_t checksum = 0;
+
+  // a download that never completed or a file that changed since then
+  // cannot be trusted, it will be downloaded again
+  if(!find(path, url, identity, &size, &mtime, &checksum) || size < 0)
+    return false;
+
+  int64_t actualSize;
+  time_t actualMtime;
+  uint32_t actualChecksum;
+
+  if(!FS::stat(path.temp(), &actualSize, &actualMtime) ||
+      actualSize != size || actualMtime != mtime)
+    return false;
+  else if(!FS::checksum(path.temp(), &actualChecksum) ||
+      actualChecksum != checksum)
+    return false;
+
+  m_owned.insert(path.target().join());
+
+  return true;
+}
+
+int64_t Journal::resumable(const TempPath &path, const string &url,
+  const string &identity)
+{
+  int64_t size = -1;
+  time_t mtime = 0;
+  uint32_t checksum;
+
+  // only downloads of the same file that were interrupted midway
+  if(!find(path, url, identity, &size, &mtime, &checksum) || size >= 0)
+    return 0;
+
+  int64_t partialSize;
+  time_t partialMtime;
+
+  if(!FS::stat(path.temp(), &partialSize, &partialMtime))
+    return 0;
+
+  return partialSize;
+}
+
+void Journal::purge()
+{
+  // files already moved in place are gone, the others are leftovers of
+  // this transaction or of an interrupted one nobody resumed in time
+  vector<string> targets(m_owned.begin(), m_owned.end());
+
+  const StatementPtr &stmt = m_db.cached("SELECT path FROM staged WHERE planned < ?");
+  stmt->bind(1, time(nullptr) - MAX_AGE);
+  stmt->exec([&] {
+    targets.push_back(stmt->stringColumn(0));
+    return true;
+  });
+
+  m_db.begin();
+
+  for(const string &target : targets) {
+    const TempPath paths{Path(target)};
+    FS::remove(paths.temp());
+    FS::remove(paths.validator());
+
+    m_forget->bind(1, target);
+    m_forget->exec();
+  }
+
+  m_db.commit();
+
+  m_owned.clear();
+}
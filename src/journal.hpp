@@ -0,0 +1,62 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_JOURNAL_HPP
+#define REAPACK_JOURNAL_HPP
+
+#include "database.hpp"
+
+#include <ctime>
+#include <string>
+#include <unordered_set>
+
+class Path;
+class TempPath;
+
+// Keeps track of the files staged by a transaction so that a later one can
+// pick up where an interrupted one left (eg. if REAPER was closed).
+class Journal {
+public:
+  Journal(const Path &);
+
+  void plan(const TempPath &, const std::string &url,
+    const std::string &identity);
+  void staged(const TempPath &);
+  bool adopt(const TempPath &, const std::string &url,
+    const std::string &identity);
+  int64_t resumable(const TempPath &, const std::string &url,
+    const std::string &identity);
+  void purge();
+
+private:
+  void migrate();
+  bool find(const TempPath &, const std::string &url,
+    const std::string &identity, int64_t *size, time_t *mtime,
+    uint32_t *checksum);
+
+  Database m_db;
+
+  Statement *m_plan;
+  Statement *m_staged;
+  Statement *m_find;
+  Statement *m_forget;
+
+  // entries planned or adopted through this instance
+  std::unordered_set<std::string> m_owned;
+};
+
+#endif
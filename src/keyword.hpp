@@ -0,0 +1,59 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_KEYWORD_HPP
+#define REAPACK_KEYWORD_HPP
+
+#include <cstdint>
+#include <cstring>
+
+// FNV-1a hash of a keyword, usable in case labels. Keywords of the same
+// vocabulary sharing a hash would be rejected by the compiler as duplicate
+// case values, so each switch statement is a perfect hash of its vocabulary.
+constexpr uint32_t KeywordHash(const char *str,
+  const uint32_t hash = 2166136261u)
+{
+  return *str ? KeywordHash(str + 1,
+    (hash ^ static_cast<uint8_t>(*str)) * 16777619u) : hash;
+}
+
+// A word read from an index file. Unknown words may hash to the same value
+// as a keyword, hence the equality check after the lookup.
+class Keyword {
+public:
+  Keyword(const char *str) : m_str(str), m_size(strlen(str)) {}
+  Keyword(const char *str, const size_t size) : m_str(str), m_size(size) {}
+
+  uint32_t hash() const
+  {
+    uint32_t hash = 2166136261u;
+    for(size_t i = 0; i < m_size; i++)
+      hash = (hash ^ static_cast<uint8_t>(m_str[i])) * 16777619u;
+    return hash;
+  }
+
+  bool operator==(const char *keyword) const
+  {
+    return !strncmp(m_str, keyword, m_size) && !keyword[m_size];
+  }
+
+private:
+  const char *m_str;
+  size_t m_size;
+};
+
+#endif
@@ -88,6 +88,9 @@ static void menuHook(const char *name, HMENU handle, int f)
   menu.addAction(AUTO_STR("&Synchronize packages"),
     NamedCommandLookup("_REAPACK_SYNC"));
 
+  menu.addAction(AUTO_STR("&Verify and repair packages"),
+    NamedCommandLookup("_REAPACK_REPAIR"));
+
   menu.addAction(AUTO_STR("&Browse packages..."),
     NamedCommandLookup("_REAPACK_BROWSE"));
 
@@ -166,6 +169,10 @@ extern "C" REAPER_PLUGIN_DLL_EXPORT int REAPER_PLUGIN_ENTRYPOINT(
   reapack->setupAction("REAPACK_SYNC", "ReaPack: Synchronize packages",
     &reapack->syncAction, bind(&ReaPack::synchronizeAll, reapack));
 
+  reapack->setupAction("REAPACK_REPAIR",
+    "ReaPack: Verify and repair installed packages",
+    &reapack->repairAction, bind(&ReaPack::repairAll, reapack));
+
   reapack->setupAction("REAPACK_BROWSE", "ReaPack: Browse packages...",
     &reapack->browseAction, bind(&ReaPack::browsePackages, reapack));
 
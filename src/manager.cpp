@@ -44,8 +44,8 @@ enum {
   ACTION_REFRESH, ACTION_COPYURL, ACTION_SELECT, ACTION_UNSELECT,
   ACTION_AUTOINSTALL_GLOBAL, ACTION_AUTOINSTALL_OFF, ACTION_AUTOINSTALL_ON,
   ACTION_AUTOINSTALL, ACTION_BLEEDINGEDGE, ACTION_PROMPTOBSOLETE,
-  ACTION_NETCONFIG, ACTION_RESETCONFIG, ACTION_IMPORT_REPO,
-  ACTION_IMPORT_ARCHIVE, ACTION_EXPORT_ARCHIVE
+  ACTION_SYNCFILES, ACTION_SHAREFILES, ACTION_NETCONFIG, ACTION_RESETCONFIG,
+  ACTION_IMPORT_REPO, ACTION_IMPORT_ARCHIVE, ACTION_EXPORT_ARCHIVE
 };
 
 Manager::Manager(ReaPack *reapack)
@@ -151,6 +151,12 @@ void Manager::onCommand(const int id, int)
   case ACTION_PROMPTOBSOLETE:
     toggle(m_promptObsolete, m_config->install.promptObsolete);
     break;
+  case ACTION_SYNCFILES:
+    toggle(m_syncFiles, m_config->install.syncFiles);
+    break;
+  case ACTION_SHAREFILES:
+    toggle(m_shareFiles, m_config->install.shareFiles);
+    break;
   case ACTION_NETCONFIG:
     setupNetwork();
     break;
@@ -602,6 +608,17 @@ void Manager::options()
   if(m_promptObsolete.value_or(m_config->install.promptObsolete))
     menu.check(index);
 
+  index = menu.addAction(
+    AUTO_STR("Flush installed files to &disk"), ACTION_SYNCFILES);
+  if(m_syncFiles.value_or(m_config->install.syncFiles))
+    menu.check(index);
+
+  index = menu.addAction(
+    AUTO_STR("&Share identical files between packages (hard links: editing one edits all)"),
+    ACTION_SHAREFILES);
+  if(m_shareFiles.value_or(m_config->install.shareFiles))
+    menu.check(index);
+
   menu.addAction(AUTO_STR("&Network settings..."), ACTION_NETCONFIG);
 
   menu.addSeparator();
@@ -659,6 +676,12 @@ bool Manager::apply()
   if(m_promptObsolete)
     m_config->install.promptObsolete = m_promptObsolete.value();
 
+  if(m_syncFiles)
+    m_config->install.syncFiles = m_syncFiles.value();
+
+  if(m_shareFiles)
+    m_config->install.shareFiles = m_shareFiles.value();
+
   for(const auto &pair : m_mods) {
     Remote remote = pair.first;
     const RemoteMods &mods = pair.second;
@@ -702,6 +725,8 @@ void Manager::reset()
   m_autoInstall = boost::none;
   m_bleedingEdge = boost::none;
   m_promptObsolete = boost::none;
+  m_syncFiles = boost::none;
+  m_shareFiles = boost::none;
 
   m_changes = 0;
   disable(m_apply);
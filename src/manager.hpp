@@ -94,6 +94,8 @@ private:
   boost::optional<bool> m_autoInstall;
   boost::optional<bool> m_bleedingEdge;
   boost::optional<bool> m_promptObsolete;
+  boost::optional<bool> m_syncFiles;
+  boost::optional<bool> m_shareFiles;
 
   Serializer m_serializer;
 };
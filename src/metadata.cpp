@@ -17,16 +17,22 @@
 
 #include "metadata.hpp"
 
+#include "keyword.hpp"
+
 #include <boost/algorithm/string/predicate.hpp>
 
-auto Metadata::getLinkType(const char *rel) -> LinkType
+auto Metadata::getLinkType(const char *name) -> LinkType
 {
-  if(!strcmp(rel, "donation"))
-    return DonationLink;
-  else if(!strcmp(rel, "screenshot"))
-    return ScreenshotLink;
+  const Keyword rel(name);
 
-  return WebsiteLink;
+  switch(rel.hash()) {
+  case KeywordHash("donation"):
+    return rel == "donation" ? DonationLink : WebsiteLink;
+  case KeywordHash("screenshot"):
+    return rel == "screenshot" ? ScreenshotLink : WebsiteLink;
+  default:
+    return WebsiteLink;
+  }
 }
 
 void Metadata::addLink(const LinkType type, const Link &link)
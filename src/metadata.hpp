@@ -18,6 +18,7 @@
 #ifndef REAPACK_METADATA_HPP
 #define REAPACK_METADATA_HPP
 
+#include <boost/utility/string_view.hpp>
 #include <map>
 #include <string>
 #include <vector>
@@ -34,13 +35,18 @@ public:
 
   static LinkType getLinkType(const char *rel);
 
-  void setAbout(const std::string &rtf) { m_about = rtf; }
-  const std::string &about() const { return m_about; }
+  void setAbout(const std::string &rtf) { m_about = rtf; m_aboutRef = {}; }
+  // the text must outlive the metadata (eg. in the arena of its index)
+  void setAboutRef(boost::string_view rtf) { m_aboutRef = rtf; }
+  // a view of either text: large RTF documents are never copied on access
+  boost::string_view about() const
+    { return m_aboutRef.data() ? m_aboutRef : boost::string_view(m_about); }
   void addLink(const LinkType, const Link &);
   const auto &links() const { return m_links; }
 
 private:
   std::string m_about;
+  boost::string_view m_aboutRef;
   std::multimap<LinkType, Link> m_links;
 };
 
@@ -58,8 +58,8 @@ OutputStream &OutputStream::operator<<(const Version &ver)
 
   m_stream << "\r\n";
 
-  const string &changelog = ver.changelog();
-  indented(changelog.empty() ? "No changelog" : changelog);
+  const boost::string_view &changelog = ver.changelog();
+  indented(changelog.empty() ? "No changelog" : changelog.to_string());
 
   return *this;
 }
@@ -19,52 +19,56 @@
 
 #include "errors.hpp"
 #include "index.hpp"
+#include "keyword.hpp"
 
 #include <algorithm>
-#include <boost/range/adaptor/reversed.hpp>
 
 using boost::format;
 using namespace std;
 
-Package::Type Package::getType(const char *type)
+Package::Type Package::getType(const char *name)
 {
-  if(!strcmp(type, "script"))
-    return ScriptType;
-  else if(!strcmp(type, "extension"))
-    return ExtensionType;
-  else if(!strcmp(type, "effect"))
-    return EffectType;
-  else if(!strcmp(type, "data"))
-    return DataType;
-  else if(!strcmp(type, "theme"))
-    return ThemeType;
-  else if(!strcmp(type, "langpack"))
-    return LangPackType;
-  else if(!strcmp(type, "webinterface"))
-    return WebInterfaceType;
-  else
+  const Keyword type(name);
+
+  switch(type.hash()) {
+  case KeywordHash("script"):
+    return type == "script" ? ScriptType : UnknownType;
+  case KeywordHash("extension"):
+    return type == "extension" ? ExtensionType : UnknownType;
+  case KeywordHash("effect"):
+    return type == "effect" ? EffectType : UnknownType;
+  case KeywordHash("data"):
+    return type == "data" ? DataType : UnknownType;
+  case KeywordHash("theme"):
+    return type == "theme" ? ThemeType : UnknownType;
+  case KeywordHash("langpack"):
+    return type == "langpack" ? LangPackType : UnknownType;
+  case KeywordHash("webinterface"):
+    return type == "webinterface" ? WebInterfaceType : UnknownType;
+  default:
     return UnknownType;
+  }
 }
 
-string Package::displayType(const Type type)
+const string &Package::displayType(const Type type)
 {
+  // one copy of each name for every package of every index
+  static const string names[] = {
+    "Unknown", "Script", "Extension", "Effect", "Data", "Theme",
+    "Language Pack", "Web Interface",
+  };
+
   switch(type) {
   case ScriptType:
-    return "Script";
   case ExtensionType:
-    return "Extension";
   case EffectType:
-    return "Effect";
   case DataType:
-    return "Data";
   case ThemeType:
-    return "Theme";
   case LangPackType:
-    return "Language Pack";
   case WebInterfaceType:
-    return "Web Interface";
+    return names[type];
   default:
-    return "Unknown";
+    return names[UnknownType];
   }
 }
 
@@ -78,7 +82,7 @@ const string &Package::displayName(const string &name,
 }
 
 Package::Package(const Type type, const string &name, const Category *cat)
-  : m_category(cat), m_type(type), m_name(name)
+  : m_category(cat), m_type(type), m_name(name), m_lastStable(nullptr)
 {
   if(m_name.empty())
     throw reapack_error("empty package name");
@@ -86,12 +90,6 @@ Package::Package(const Type type, const string &name, const Category *cat)
     throw reapack_error(format("invalid package name '%s'") % m_name);
 }
 
-Package::~Package()
-{
-  for(const Version *ver : m_versions)
-    delete ver;
-}
-
 string Package::fullName() const
 {
   return m_category ? m_category->fullName() + "/" + displayName() : displayName();
@@ -103,22 +101,27 @@ bool Package::addVersion(const Version *ver)
     throw reapack_error("version belongs to another package");
   else if(ver->sources().empty())
     return false;
-  else if(m_versions.count(ver))
+
+  // indexes usually list versions in ascending order: append in O(1)
+  auto it = m_versions.end();
+  if(!m_versions.empty() && !CompareVersion(m_versions.back(), ver))
+    it = lower_bound(m_versions.begin(), m_versions.end(), ver, &CompareVersion);
+
+  if(it != m_versions.end() && (*it)->name() == ver->name())
     throw reapack_error(format("duplicate version '%s'") % ver->fullName());
 
-  m_versions.insert(ver);
+  m_versions.insert(it, ver);
+
+  if(ver->name().isStable() &&
+      (!m_lastStable || CompareVersion(m_lastStable, ver)))
+    m_lastStable = ver;
 
   return true;
 }
 
 const Version *Package::version(const size_t index) const
 {
-  auto it = m_versions.begin();
-
-  for(size_t i = 0; i < index; i++)
-    it++;
-
-  return *it;
+  return m_versions[index];
 }
 
 const Version *Package::lastVersion(const bool pres, const VersionName &from) const
@@ -126,22 +129,22 @@ const Version *Package::lastVersion(const bool pres, const VersionName &from) co
   if(m_versions.empty())
     return nullptr;
 
-  for(const Version *ver : m_versions | boost::adaptors::reversed) {
-    if(ver->name() < from)
-      break;
-    else if(ver->name().isStable() || pres)
-      return ver;
-  }
+  const Version *last = pres ? m_versions.back() : m_lastStable;
+
+  if(last && last->name() >= from)
+    return last;
 
-  return from.isStable() ? nullptr : *m_versions.rbegin();
+  return from.isStable() ? nullptr : m_versions.back();
 }
 
 const Version *Package::findVersion(const VersionName &ver) const
 {
-  const auto &it = find_if(m_versions.begin(), m_versions.end(),
-    [=] (const Version *cur) { return cur->name() == ver; });
+  const auto it = lower_bound(m_versions.begin(), m_versions.end(), ver,
+    [] (const Version *cur, const VersionName &name) {
+      return cur->name() < name;
+    });
 
-  if(it == m_versions.end())
+  if(it == m_versions.end() || (*it)->name() != ver)
     return nullptr;
   else
     return *it;
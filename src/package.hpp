@@ -37,16 +37,15 @@ public:
   };
 
   static Type getType(const char *);
-  static std::string displayType(Type);
+  static const std::string &displayType(Type);
   static const std::string &displayName(const std::string &name,
     const std::string &desc, bool enableDesc = true);
 
   Package(const Type, const std::string &name, const Category *);
-  ~Package();
 
   const Category *category() const { return m_category; }
   Type type() const { return m_type; }
-  std::string displayType() const { return displayType(m_type); }
+  const std::string &displayType() const { return displayType(m_type); }
   const std::string &name() const { return m_name; }
   std::string fullName() const;
   void setDescription(const std::string &d) { m_desc = d; }
@@ -64,13 +63,10 @@ public:
   const Version *findVersion(const VersionName &) const;
 
 private:
-  class CompareVersion {
-  public:
-    bool operator()(const Version *l, const Version *r) const
-    {
-      return l->name() < r->name();
-    }
-  };
+  static bool CompareVersion(const Version *l, const Version *r)
+  {
+    return l->name() < r->name();
+  }
 
   const Category *m_category;
 
@@ -78,7 +74,8 @@ private:
   std::string m_name;
   std::string m_desc;
   Metadata m_metadata;
-  std::set<const Version *, CompareVersion> m_versions;
+  std::vector<const Version *> m_versions; // sorted from oldest to newest
+  const Version *m_lastStable;
 
 };
 
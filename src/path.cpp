@@ -18,8 +18,7 @@
 #include "path.hpp"
 
 #include <algorithm>
-#include <boost/range/adaptor/reversed.hpp>
-#include <vector>
+#include <cstring>
 
 using namespace std;
 
@@ -29,94 +28,122 @@ static const char SEPARATOR = '/';
 static const char SEPARATOR = '\\';
 #endif
 
-static const string DOT = ".";
-static const string DOTDOT = "..";
-
 Path Path::DATA = Path("ReaPack");
 Path Path::CACHE = Path::DATA + "cache";
 Path Path::CONFIG = Path("reapack.ini");
 Path Path::REGISTRY = Path::DATA + "registry.db";
+Path Path::JOURNAL = Path::DATA + "journal.db";
+Path Path::STORE = Path::DATA + "store";
 
 Path Path::s_root;
 
-static vector<string> Split(const string &input, bool *absolute)
+Path::Path(const string &path) : m_size(0), m_absolute(false)
+{
+  append(path);
+}
+
+void Path::push(const char *part, const size_t size)
 {
-  vector<string> list;
+  if(m_size || m_absolute)
+    m_path += SEPARATOR;
+
+  m_path.append(part, size);
+  m_size++;
+}
 
+void Path::append(const string &input, const bool traversal)
+{
+  if(input.empty())
+    return;
+
+  const bool wasEmpty = empty();
+  const char *str = input.c_str();
   size_t last = 0, size = input.size();
 
   while(last < size) {
     const size_t pos = input.find_first_of("\\/", last);
 
     if(pos == string::npos) {
-      list.push_back(input.substr(last));
+      // the last component is kept as is
+      if(strcmp(str + last, ".."))
+        push(str + last, size - last);
+      else if(traversal)
+        removeLast();
       break;
     }
     else if(last + pos == 0) {
-      *absolute = true;
+      if(wasEmpty)
+        m_absolute = true;
       last++;
       continue;
     }
 
-    const string part = input.substr(last, pos - last);
+    const size_t length = pos - last;
 
-    if(!part.empty() && part != ".")
-      list.push_back(part);
+    if(length == 2 && !strncmp(str + last, "..", 2)) {
+      if(traversal)
+        removeLast();
+    }
+    else if(length && !(length == 1 && str[last] == '.'))
+      push(str + last, length);
 
     last = pos + 1;
   }
+}
+
+void Path::append(const Path &o)
+{
+  if(o.empty())
+    return;
 
-  return list;
+  if(m_size || m_absolute)
+    m_path += SEPARATOR;
+
+  m_path.append(o.m_path, o.offset(), string::npos);
+  m_size += o.m_size;
 }
 
-Path::Path(const string &path) : m_absolute(false)
+void Path::clear()
 {
-  append(path);
+  m_path.clear();
+  m_size = 0;
 }
 
-void Path::append(const string &input, const bool traversal)
+void Path::removeLast()
 {
-  if(input.empty())
+  if(empty())
     return;
 
-  bool absolute = false;
-  const auto &parts = Split(input, &absolute);
-
-  if(m_parts.empty() && absolute)
-    m_absolute = true;
+  size_t begin, end;
+  range(m_size - 1, &begin, &end);
 
-  for(const string &part : parts) {
-    if(part == DOTDOT) {
-      if(traversal)
-        removeLast();
-    }
-    else
-      m_parts.push_back(part);
-  }
+  // also remove the separator before the last component
+  m_path.resize(m_size > 1 ? begin - 1 : 0);
+  m_size--;
 }
 
-void Path::append(const Path &o)
+void Path::range(const size_t index, size_t *begin, size_t *end) const
 {
-  m_parts.insert(m_parts.end(), o.m_parts.begin(), o.m_parts.end());
-}
+  *begin = offset();
 
-void Path::clear()
-{
-  m_parts.clear();
+  for(size_t i = 0; i < index; i++)
+    *begin = m_path.find(SEPARATOR, *begin) + 1;
+
+  *end = m_path.find(SEPARATOR, *begin);
+  if(*end == string::npos)
+    *end = m_path.size();
 }
 
-void Path::removeLast()
+string Path::at(const size_t index) const
 {
-  if(!empty())
-    m_parts.pop_back();
+  size_t begin, end;
+  range(index, &begin, &end);
+  return m_path.substr(begin, end - begin);
 }
 
 string Path::basename() const
 {
-  if(empty())
-    return {};
-
-  return m_parts.back();
+  return last();
 }
 
 Path Path::dirname() const
@@ -131,17 +158,11 @@ Path Path::dirname() const
 
 string Path::join(const char sep) const
 {
-  string path;
-
-  for(auto it = m_parts.begin(); it != m_parts.end(); it++) {
-    const string &part = *it;
-
-    if(!path.empty() || m_absolute)
-      path += sep ? sep : SEPARATOR;
-
-    path += part;
-  }
+  if(!sep || sep == SEPARATOR)
+    return m_path;
 
+  string path(m_path);
+  replace(path.begin(), path.end(), SEPARATOR, sep);
   return path;
 }
 
@@ -150,7 +171,7 @@ string Path::first() const
   if(empty())
     return {};
 
-  return m_parts.front();
+  return at(0);
 }
 
 string Path::last() const
@@ -158,12 +179,14 @@ string Path::last() const
   if(empty())
     return {};
 
-  return m_parts.back();
+  const size_t pos = m_path.rfind(SEPARATOR);
+  return pos == string::npos ? m_path : m_path.substr(pos + 1);
 }
 
 bool Path::operator==(const Path &o) const
 {
-  return m_parts == o.m_parts;
+  return m_size == o.m_size &&
+    !m_path.compare(offset(), string::npos, o.m_path, o.offset(), string::npos);
 }
 
 bool Path::operator!=(const Path &o) const
@@ -173,7 +196,24 @@ bool Path::operator!=(const Path &o) const
 
 bool Path::operator<(const Path &o) const
 {
-  return m_parts < o.m_parts;
+  // same ordering as comparing the components one by one:
+  // the end of a component sorts before any other character
+  const char *l = m_path.c_str() + offset(),
+    *lend = m_path.c_str() + m_path.size();
+  const char *r = o.m_path.c_str() + o.offset(),
+    *rend = o.m_path.c_str() + o.m_path.size();
+
+  const auto diff = mismatch(l, l + min(lend - l, rend - r), r);
+
+  if(diff.first == lend || diff.second == rend)
+    return lend - l < rend - r;
+  else if(*diff.first == SEPARATOR)
+    return true;
+  else if(*diff.second == SEPARATOR)
+    return false;
+  else
+    return static_cast<unsigned char>(*diff.first) <
+      static_cast<unsigned char>(*diff.second);
 }
 
 Path Path::operator+(const string &part) const
@@ -204,24 +244,30 @@ const Path &Path::operator+=(const Path &o)
   return *this;
 }
 
-const string &Path::at(const size_t index) const
+auto Path::operator[](const size_t index) -> Part
 {
-  auto it = m_parts.begin();
-
-  for(size_t i = 0; i < index; i++)
-    it++;
+  return {this, index};
+}
 
-  return *it;
+string Path::operator[](const size_t index) const
+{
+  return at(index);
 }
 
-string &Path::operator[](const size_t index)
+auto Path::Part::operator=(const string &value) -> Part &
 {
-  return const_cast<string &>(at(index));
+  size_t begin, end;
+  m_path->range(m_index, &begin, &end);
+  m_path->m_path.replace(begin, end - begin, value);
+  return *this;
 }
 
-const string &Path::operator[](const size_t index) const
+auto Path::Part::operator+=(const string &value) -> Part &
 {
-  return at(index);
+  size_t begin, end;
+  m_path->range(m_index, &begin, &end);
+  m_path->m_path.insert(end, value);
+  return *this;
 }
 
 UseRootPath::UseRootPath(const string &path)
@@ -240,3 +286,10 @@ TempPath::TempPath(const Path &target)
 {
   m_temp[m_temp.size() - 1] += ".part";
 }
+
+Path TempPath::validator() const
+{
+  Path path = m_temp;
+  path[path.size() - 1] += ".validator";
+  return path;
+}
@@ -18,17 +18,37 @@
 #ifndef REAPACK_PATH_HPP
 #define REAPACK_PATH_HPP
 
-#include <list>
 #include <string>
 
 class UseRootPath;
 
+// The components are stored in a single string joined by the native
+// separator, so joining, copying and comparing paths are linear scans over
+// contiguous memory rather than walks over a list of strings.
 class Path {
 public:
+  // writable reference to a component of a path
+  class Part {
+  public:
+    Part(Path *path, size_t index) : m_path(path), m_index(index) {}
+
+    operator std::string() const { return m_path->at(m_index); }
+    Part &operator=(const std::string &);
+    Part &operator+=(const std::string &);
+    bool operator==(const std::string &o) const
+      { return m_path->at(m_index) == o; }
+
+  private:
+    Path *m_path;
+    size_t m_index;
+  };
+
   static Path DATA;
   static Path CACHE;
   static Path CONFIG;
   static Path REGISTRY;
+  static Path JOURNAL;
+  static Path STORE;
 
   static Path prefixRoot(const Path &p) { return s_root + p; }
   static Path prefixRoot(const std::string &p) { return s_root + p; }
@@ -40,8 +60,8 @@ public:
   void removeLast();
   void clear();
 
-  bool empty() const { return m_parts.empty(); }
-  size_t size() const { return m_parts.size(); }
+  bool empty() const { return m_size == 0; }
+  size_t size() const { return m_size; }
   bool absolute() const { return m_absolute; }
 
   std::string basename() const;
@@ -57,16 +77,20 @@ public:
   Path operator+(const Path &) const;
   const Path &operator+=(const std::string &);
   const Path &operator+=(const Path &);
-  std::string &operator[](size_t);
-  const std::string &operator[](size_t) const;
+  Part operator[](size_t);
+  std::string operator[](size_t) const;
 
 private:
   static Path s_root;
   friend UseRootPath;
 
-  const std::string &at(size_t) const;
+  size_t offset() const { return m_absolute && m_size ? 1 : 0; }
+  void push(const char *part, size_t size);
+  void range(size_t index, size_t *begin, size_t *end) const;
+  std::string at(size_t) const;
 
-  std::list<std::string> m_parts;
+  std::string m_path;
+  size_t m_size;
   bool m_absolute;
 };
 
@@ -85,6 +109,8 @@ public:
 
   const Path &target() const { return m_target; }
   const Path &temp() const { return m_temp; }
+  // identifies the remote file a partial download of temp() came from
+  Path validator() const;
 
 private:
   Path m_target;
@@ -17,30 +17,34 @@
 
 #include "platform.hpp"
 
-#include <cstring>
+#include "keyword.hpp"
 
-auto Platform::parse(const char *platform) -> Enum
+auto Platform::parse(const char *name) -> Enum
 {
-  if(!strcmp(platform, "all"))
-    return GenericPlatform;
-  else if(!strcmp(platform, "windows"))
-    return WindowsPlatform;
-  else if(!strcmp(platform, "win32"))
-    return Win32Platform;
-  else if(!strcmp(platform, "win64"))
-    return Win64Platform;
-  else if(!strcmp(platform, "darwin"))
-    return DarwinPlatform;
-  else if(!strcmp(platform, "darwin32"))
-    return Darwin32Platform;
-  else if(!strcmp(platform, "darwin64"))
-    return Darwin64Platform;
-  else if(!strcmp(platform, "linux"))
-    return LinuxPlatform;
-  else if(!strcmp(platform, "linux64"))
-    return Linux64Platform;
-  else
+  const Keyword platform(name);
+
+  switch(platform.hash()) {
+  case KeywordHash("all"):
+    return platform == "all" ? GenericPlatform : UnknownPlatform;
+  case KeywordHash("windows"):
+    return platform == "windows" ? WindowsPlatform : UnknownPlatform;
+  case KeywordHash("win32"):
+    return platform == "win32" ? Win32Platform : UnknownPlatform;
+  case KeywordHash("win64"):
+    return platform == "win64" ? Win64Platform : UnknownPlatform;
+  case KeywordHash("darwin"):
+    return platform == "darwin" ? DarwinPlatform : UnknownPlatform;
+  case KeywordHash("darwin32"):
+    return platform == "darwin32" ? Darwin32Platform : UnknownPlatform;
+  case KeywordHash("darwin64"):
+    return platform == "darwin64" ? Darwin64Platform : UnknownPlatform;
+  case KeywordHash("linux"):
+    return platform == "linux" ? LinuxPlatform : UnknownPlatform;
+  case KeywordHash("linux64"):
+    return platform == "linux64" ? Linux64Platform : UnknownPlatform;
+  default:
     return UnknownPlatform;
+  }
 }
 
 bool Platform::test() const
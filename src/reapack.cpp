@@ -74,7 +74,7 @@ std::string ReaPack::resourcePath()
 }
 
 ReaPack::ReaPack(REAPER_PLUGIN_HINSTANCE instance)
-  : syncAction(), browseAction(), importAction(), configAction(),
+  : syncAction(), browseAction(), importAction(), configAction(), repairAction(),
     m_tx(nullptr), m_progress(nullptr), m_browser(nullptr), m_manager(nullptr),
     m_about(nullptr), m_instance(instance)
 {
@@ -102,6 +102,7 @@ ReaPack::ReaPack(REAPER_PLUGIN_HINSTANCE instance)
 ReaPack::~ReaPack()
 {
   Dialog::DestroyAll();
+  IndexCache::clear();
 
   m_config->write();
   delete m_config;
@@ -162,6 +163,26 @@ void ReaPack::synchronizeAll()
   tx->runTasks();
 }
 
+void ReaPack::repairAll()
+{
+  const vector<Remote> &remotes = m_config->remotes.getEnabled();
+
+  if(remotes.empty()) {
+    ShowMessageBox("No repository enabled, nothing to do!", "ReaPack", MB_OK);
+    return;
+  }
+
+  Transaction *tx = setupTransaction();
+
+  if(!tx)
+    return;
+
+  for(const Remote &remote : remotes)
+    tx->repair(remote);
+
+  tx->runTasks();
+}
+
 void ReaPack::setRemoteEnabled(const bool enable, const Remote &remote)
 {
   assert(m_tx);
@@ -372,7 +393,8 @@ void ReaPack::registerSelf()
   Package pkg(Package::ExtensionType, "ReaPack.ext", &cat);
   Version ver(VERSION, &pkg);
   ver.setAuthor("cfillion");
-  ver.addSource(new Source(REAPACK_FILE, "dummy url", &ver));
+  Source src(REAPACK_FILE, "dummy url", &ver);
+  ver.addSource(&src);
 
   try {
     Registry reg(Path::prefixRoot(Path::REGISTRY));
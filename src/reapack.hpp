@@ -47,6 +47,7 @@ public:
   gaccel_register_t browseAction;
   gaccel_register_t importAction;
   gaccel_register_t configAction;
+  gaccel_register_t repairAction;
 
   static std::string resourcePath();
 
@@ -59,6 +60,7 @@ public:
   bool execActions(int id, int);
 
   void synchronizeAll();
+  void repairAll();
   void setRemoteEnabled(bool enable, const Remote &);
   void enable(const Remote &r) { setRemoteEnabled(true, r); }
   void uninstall(const Remote &);
@@ -18,24 +18,51 @@
 #include "registry.hpp"
 
 #include "errors.hpp"
+#include "filesystem.hpp"
 #include "index.hpp"
 #include "package.hpp"
 #include "path.hpp"
 #include "remote.hpp"
 
-#include <sqlite3.h>
+#include <algorithm>
+#include <unordered_set>
 
 using namespace std;
 
-Registry::Registry(const Path &path)
-  : m_db(path.join()), m_savePoint(0)
+static const Database::Version SCHEMA{0, 8};
+
+Registry::Registry(const Path &path, const Mode mode)
+  : m_db(mode == ReadOnly && !FS::exists(path) ? string() : path.join(),
+      mode == ReadOnly ? Database::ReadOnly : Database::ReadWrite),
+    m_savePoint(0)
 {
-  migrate();
+  if(mode == ReadWrite) {
+    enableWAL();
+    migrate();
+  }
+  else {
+    checkVersion();
+
+    // readers never write to the file: until a writer creates or upgrades
+    // the registry, they read from an upgraded copy kept in memory
+    if(m_db.version() < SCHEMA) {
+      m_db.loadInMemory();
+      migrate();
+    }
+  }
 
   // entry queries
+  m_insertRemote = m_db.prepare("INSERT OR IGNORE INTO remotes(name) VALUES(?)");
+  m_insertCategory = m_db.prepare(
+    "INSERT OR IGNORE INTO categories(name) VALUES(?)");
+
   m_insertEntry = m_db.prepare(
     "INSERT INTO entries(remote, category, package, desc, type, version, author)"
-    "VALUES(?, ?, ?, ?, ?, ?, ?);"
+    "VALUES("
+    "  (SELECT id FROM remotes WHERE name = ?),"
+    "  (SELECT id FROM categories WHERE name = ?),"
+    "  ?, ?, ?, ?, ?"
+    ");"
   );
 
   m_updateEntry = m_db.prepare(
@@ -46,51 +73,137 @@ Registry::Registry(const Path &path)
   m_setPinned = m_db.prepare("UPDATE entries SET pinned = ? WHERE id = ?");
 
   m_findEntry = m_db.prepare(
-    "SELECT id, remote, category, package, desc, type, version, author, pinned "
-    "FROM entries WHERE remote = ? AND category = ? AND package = ? LIMIT 1"
+    "SELECT e.id, r.name, c.name, package, desc, type, version, author, pinned "
+    "FROM entries e "
+    "JOIN remotes r ON r.id = e.remote "
+    "JOIN categories c ON c.id = e.category "
+    "WHERE r.name = ? AND c.name = ? AND package = ? LIMIT 1"
   );
 
   m_allEntries = m_db.prepare(
-    "SELECT id, remote, category, package, desc, type, version, author, pinned "
-    "FROM entries WHERE remote = ?"
+    "SELECT e.id, r.name, c.name, package, desc, type, version, author, pinned "
+    "FROM entries e "
+    "JOIN remotes r ON r.id = e.remote "
+    "JOIN categories c ON c.id = e.category "
+    "WHERE r.name = ?"
   );
   m_forgetEntry = m_db.prepare("DELETE FROM entries WHERE id = ?");
 
-  // file queries
-  m_getFiles = m_db.prepare(
-    "SELECT path, main, type FROM files WHERE entry = ? ORDER BY path"
+  // drop the remote and category rows once their last entry is gone
+  m_forgetRemote = m_db.prepare(
+    "DELETE FROM remotes WHERE name = ? AND NOT EXISTS("
+    "  SELECT 1 FROM entries WHERE remote = remotes.id)"
   );
-  m_insertFile = m_db.prepare("INSERT INTO files VALUES(NULL, ?, ?, ?, ?)");
-  m_clearFiles = m_db.prepare(
-    "DELETE FROM files WHERE entry = ("
-    "  SELECT id FROM entries WHERE remote = ? AND category = ? AND package = ?"
-    ")"
+  m_forgetCategory = m_db.prepare(
+    "DELETE FROM categories WHERE name = ? AND NOT EXISTS("
+    "  SELECT 1 FROM entries WHERE category = categories.id)"
   );
+
+  // file queries (by entry id through the files_entry index)
+  m_getFiles = m_db.prepare(
+    "SELECT path, main, type, IFNULL(size, -1), IFNULL(mtime, 0),"
+    "  IFNULL(checksum, 0), stored "
+    "FROM files WHERE entry = ? ORDER BY path"
+  );
+  m_insertFile = m_db.prepare(
+    "INSERT INTO files(entry, path, main, type) VALUES(?, ?, ?, ?)");
   m_forgetFiles = m_db.prepare("DELETE FROM files WHERE entry = ?");
+  m_setManifest = m_db.prepare(
+    "UPDATE files SET size = ?, mtime = ?, checksum = ?, stored = ? "
+    "WHERE path = ?");
+
+  // entries with all their files, one row per file
+  m_remoteFiles = m_db.prepare(
+    "SELECT e.id, r.name, c.name, package, desc, e.type, version, author,"
+    "  pinned, f.path, f.main, f.type, IFNULL(f.size, -1),"
+    "  IFNULL(f.mtime, 0), IFNULL(f.checksum, 0), IFNULL(f.stored, 0) "
+    "FROM entries e "
+    "JOIN remotes r ON r.id = e.remote "
+    "JOIN categories c ON c.id = e.category "
+    "LEFT JOIN files f ON f.entry = e.id "
+    "WHERE r.name = ? "
+    "ORDER BY e.id, f.path"
+  );
+
+  // grouped by remote so each repository's entries come in one run
+  m_allFiles = m_db.prepare(
+    "SELECT e.id, r.name, c.name, package, desc, e.type, version, author,"
+    "  pinned, f.path, f.main, f.type, IFNULL(f.size, -1),"
+    "  IFNULL(f.mtime, 0), IFNULL(f.checksum, 0), IFNULL(f.stored, 0) "
+    "FROM entries e "
+    "JOIN remotes r ON r.id = e.remote "
+    "JOIN categories c ON c.id = e.category "
+    "LEFT JOIN files f ON f.entry = e.id "
+    "ORDER BY e.remote, e.id, f.path"
+  );
 
-  // lock the database
-  m_db.begin();
+  if(mode == ReadOnly) {
+    m_db.exec("PRAGMA query_only = 1");
+    m_db.beginSnapshot();
+  }
+  else {
+    // lock the database
+    m_db.begin();
+  }
+}
+
+void Registry::enableWAL()
+{
+  // readers keep working on their own snapshot while a transaction is
+  // writing (the journal mode is persistent, readers inherit it)
+  Statement *wal = m_db.prepare("PRAGMA journal_mode = WAL");
+
+  string journalMode;
+  wal->exec([&] {
+    journalMode = wal->stringColumn(0);
+    return false;
+  });
+
+  // WAL requires shared memory, which is unavailable on network filesystems:
+  // keep the rollback journal there (readers then wait for the writer)
+  if(journalMode != "wal" && journalMode != "memory")
+    m_db.exec("PRAGMA journal_mode = DELETE");
+}
+
+void Registry::checkVersion() const
+{
+  if(m_db.version().major > SCHEMA.major) {
+    throw reapack_error(
+      "The package registry was created by a newer version of ReaPack");
+  }
 }
 
 void Registry::migrate()
 {
-  const Database::Version version{0, 5};
+  const Database::Version &version = SCHEMA;
   const Database::Version &current = m_db.version();
 
   if(!current) {
     // new database!
     m_db.exec(
+      "CREATE TABLE remotes ("
+      "  id INTEGER PRIMARY KEY,"
+      "  name TEXT UNIQUE NOT NULL"
+      ");"
+
+      "CREATE TABLE categories ("
+      "  id INTEGER PRIMARY KEY,"
+      "  name TEXT UNIQUE NOT NULL"
+      ");"
+
       "CREATE TABLE entries ("
       "  id INTEGER PRIMARY KEY,"
-      "  remote TEXT NOT NULL,"
-      "  category TEXT NOT NULL,"
+      "  remote INTEGER NOT NULL,"
+      "  category INTEGER NOT NULL,"
       "  package TEXT NOT NULL,"
       "  desc TEXT NOT NULL,"
       "  type INTEGER NOT NULL,"
       "  version TEXT NOT NULL,"
       "  author TEXT NOT NULL,"
       "  pinned INTEGER DEFAULT 0,"
-      "  UNIQUE(remote, category, package)"
+      "  UNIQUE(remote, category, package),"
+      "  FOREIGN KEY(remote) REFERENCES remotes(id),"
+      "  FOREIGN KEY(category) REFERENCES categories(id)"
       ");"
 
       "CREATE TABLE files ("
@@ -99,8 +212,15 @@ void Registry::migrate()
       "  path TEXT UNIQUE NOT NULL,"
       "  main INTEGER NOT NULL,"
       "  type INTEGER NOT NULL,"
+      "  size INTEGER,"
+      "  mtime INTEGER,"
+      "  checksum INTEGER,"
+      "  stored INTEGER NOT NULL DEFAULT 0,"
       "  FOREIGN KEY(entry) REFERENCES entries(id)"
       ");"
+
+      "CREATE INDEX files_entry ON files(entry);"
+      "CREATE INDEX files_stored ON files(checksum, size) WHERE stored;"
     );
 
     m_db.setVersion(version);
@@ -108,6 +228,16 @@ void Registry::migrate()
     return;
   }
   else if(current < version) {
+    // tables referenced by foreign keys may be rebuilt (has no effect
+    // inside of a transaction)
+    Statement *getForeignKeys = m_db.prepare("PRAGMA foreign_keys");
+    bool foreignKeys = false;
+    getForeignKeys->exec([&] {
+      foreignKeys = getForeignKeys->boolColumn(0);
+      return false;
+    });
+
+    m_db.exec("PRAGMA foreign_keys = 0");
     m_db.begin();
 
     switch(current.major) {
@@ -128,32 +258,126 @@ void Registry::migrate()
       m_db.exec("ALTER TABLE entries ADD COLUMN desc TEXT NOT NULL DEFAULT '';");
     case 4:
       convertImplicitSections();
+    case 5:
+      normalizeNames();
+    case 6:
+      m_db.exec(
+        "ALTER TABLE files ADD COLUMN size INTEGER;"
+        "ALTER TABLE files ADD COLUMN mtime INTEGER;"
+        "ALTER TABLE files ADD COLUMN checksum INTEGER;"
+      );
+    case 7:
+      m_db.exec(
+        "ALTER TABLE files ADD COLUMN stored INTEGER NOT NULL DEFAULT 0;"
+        "CREATE INDEX files_stored ON files(checksum, size) WHERE stored;"
+      );
     }
 
     m_db.setVersion(version);
     m_db.commit();
+
+    if(foreignKeys)
+      m_db.exec("PRAGMA foreign_keys = 1");
   }
 }
 
-auto Registry::push(const Version *ver, vector<Path> *conflicts) -> Entry
+auto Registry::conflicts(const vector<const Version *> &versions)
+  -> vector<Conflict>
 {
-  savepoint();
+  // look up the current owner of every target path in a single query
+  m_db.exec(
+    "CREATE TEMP TABLE IF NOT EXISTS lookup (path TEXT NOT NULL);"
+    "DELETE FROM temp.lookup;"
+  );
+
+  const StatementPtr &insert = m_db.cached("INSERT INTO temp.lookup VALUES(?)");
+
+  for(const Version *ver : versions) {
+    for(const Source *src : ver->sources()) {
+      insert->bind(1, src->targetPath().join('/'));
+      insert->exec();
+    }
+  }
+
+  struct Owner { string key; string name; };
+  unordered_map<string, Owner> owners;
+
+  const StatementPtr &select = m_db.cached(
+    "SELECT r.name, c.name, package, version, f.path "
+    "FROM temp.lookup l "
+    "JOIN files f ON f.path = l.path "
+    "JOIN entries e ON e.id = f.entry "
+    "JOIN remotes r ON r.id = e.remote "
+    "JOIN categories c ON c.id = e.category"
+  );
+
+  select->exec([&] {
+    const string &remote = select->stringColumn(0),
+      &cat = select->stringColumn(1), &pkg = select->stringColumn(2);
+
+    owners.emplace(select->stringColumn(4), Owner{key(remote, cat, pkg),
+      remote + "/" + cat + "/" + pkg + " v" + select->stringColumn(3)});
+
+    return true;
+  });
+
+  m_db.exec("DELETE FROM temp.lookup");
+
+  // then resolve conflicts between the given versions, in order:
+  // a version that conflicts does not take ownership of any file, and a
+  // package being updated releases the files its new version no longer has
+  vector<Conflict> list;
+  unordered_map<string, pair<string, const Version *> > claimed;
+  unordered_set<string> replaced;
+
+  for(const Version *ver : versions) {
+    const string &pkgKey = key(ver->package());
+    const size_t count = list.size();
+    vector<string> paths;
+
+    for(const Source *src : ver->sources()) {
+      const Path &path = src->targetPath();
+      string file = path.join('/');
 
-  bool hasConflicts = false;
+      const auto claim = claimed.find(file);
+      const auto owner = owners.find(file);
 
+      if(find(paths.begin(), paths.end(), file) != paths.end())
+        list.push_back({ver, path, ver->fullName()});
+      else if(claim != claimed.end() && claim->second.first != pkgKey)
+        list.push_back({ver, path, claim->second.second->fullName()});
+      else if(claim == claimed.end() && owner != owners.end() &&
+          owner->second.key != pkgKey && !replaced.count(owner->second.key))
+        list.push_back({ver, path, owner->second.name});
+
+      paths.push_back(move(file));
+    }
+
+    if(list.size() > count)
+      continue;
+
+    for(string &file : paths)
+      claimed[move(file)] = {pkgKey, ver};
+
+    replaced.insert(pkgKey);
+  }
+
+  return list;
+}
+
+auto Registry::push(const Version *ver) -> Entry
+{
   const Package *pkg = ver->package();
   const Category *cat = pkg->category();
   const Index *ri = cat->index();
 
-  m_clearFiles->bind(1, ri->name());
-  m_clearFiles->bind(2, cat->name());
-  m_clearFiles->bind(3, pkg->name());
-  m_clearFiles->exec();
-
   auto entryId = getEntry(ver->package()).id;
 
   // register or update package and version
   if(entryId) {
+    m_forgetFiles->bind(1, entryId);
+    m_forgetFiles->exec();
+
     m_updateEntry->bind(1, pkg->description());
     m_updateEntry->bind(2, pkg->type());
     m_updateEntry->bind(3, ver->name().toString());
@@ -162,6 +386,11 @@ auto Registry::push(const Version *ver, vector<Path> *conflicts) -> Entry
     m_updateEntry->exec();
   }
   else {
+    m_insertRemote->bind(1, ri->name());
+    m_insertRemote->exec();
+    m_insertCategory->bind(1, cat->name());
+    m_insertCategory->exec();
+
     m_insertEntry->bind(1, ri->name());
     m_insertEntry->bind(2, cat->name());
     m_insertEntry->bind(3, pkg->name());
@@ -174,41 +403,57 @@ auto Registry::push(const Version *ver, vector<Path> *conflicts) -> Entry
     entryId = m_db.lastInsertId();
   }
 
-  // register files
+  // register files (conflicts are expected to have been checked already)
   for(const Source *src : ver->sources()) {
-    const Path &path = src->targetPath();
-
     m_insertFile->bind(1, entryId);
-    m_insertFile->bind(2, path.join('/'));
+    m_insertFile->bind(2, src->targetPath().join('/'));
     m_insertFile->bind(3, src->sections());
     m_insertFile->bind(4, src->typeOverride());
-
-    try {
-      m_insertFile->exec();
-    }
-    catch(const reapack_error &) {
-      if(conflicts && m_db.errorCode() == SQLITE_CONSTRAINT) {
-        hasConflicts = true;
-        conflicts->push_back(path);
-      }
-      else {
-        restore();
-        throw;
-      }
-    }
+    m_insertFile->exec();
   }
 
-  if(hasConflicts) {
-    restore();
-    return {};
-  }
-  else {
-    release();
-    return {entryId, ri->name(), cat->name(),
-      pkg->name(), pkg->description(), pkg->type(), ver->name(), ver->author()};
-  }
+  return {entryId, ri->name(), cat->name(),
+    pkg->name(), pkg->description(), pkg->type(), ver->name(), ver->author()};
+}
+
+Registry::EntryMap::EntryMap(const vector<Entry> &entries)
+  : m_null{}
+{
+  m_entries.reserve(entries.size());
+
+  for(const Entry &entry : entries)
+    m_entries.emplace(key(entry.remote, entry.category, entry.package), entry);
+}
+
+auto Registry::EntryMap::find(const Package *pkg) const -> const Entry &
+{
+  const auto it = m_entries.find(Registry::key(pkg));
+
+  return it == m_entries.end() ? m_null : it->second;
+}
+
+string Registry::key(const Package *pkg)
+{
+  const Category *cat = pkg->category();
+  return key(cat->index()->name(), cat->name(), pkg->name());
+}
+
+string Registry::key(const string &remote,
+  const string &cat, const string &pkg)
+{
+  // names cannot contain null characters
+  string key;
+  key.reserve(remote.size() + cat.size() + pkg.size() + 2);
+  key += remote;
+  key += '\0';
+  key += cat;
+  key += '\0';
+  key += pkg;
+
+  return key;
 }
 
+
 void Registry::setPinned(const Entry &entry, const bool pinned)
 {
   m_setPinned->bind(1, pinned);
@@ -216,6 +461,34 @@ void Registry::setPinned(const Entry &entry, const bool pinned)
   m_setPinned->exec();
 }
 
+void Registry::setManifest(const File &file)
+{
+  m_setManifest->bind(1, file.size);
+  m_setManifest->bind(2, file.mtime);
+  m_setManifest->bind(3, file.checksum);
+  m_setManifest->bind(4, file.stored);
+  m_setManifest->bind(5, file.path.join('/'));
+  m_setManifest->exec();
+}
+
+int64_t Registry::storeLinks(const File &file) const
+{
+  int64_t count = 0;
+
+  // identical contents share a single copy in the content store
+  // (looked up through the partial files_stored index)
+  const StatementPtr &stmt = m_db.cached(
+    "SELECT COUNT(*) FROM files WHERE stored AND checksum = ? AND size = ?");
+  stmt->bind(1, file.checksum);
+  stmt->bind(2, file.size);
+  stmt->exec([&] {
+    count = stmt->intColumn(0);
+    return false;
+  });
+
+  return count;
+}
+
 auto Registry::getEntry(const Package *pkg) const -> Entry
 {
   Entry entry{};
@@ -260,13 +533,8 @@ auto Registry::getFiles(const Entry &entry) const -> vector<File>
 
   m_getFiles->bind(1, entry.id);
   m_getFiles->exec([&] {
-    File file{m_getFiles->stringColumn(0)};
-    file.sections = static_cast<int>(m_getFiles->intColumn(1));
-    file.type = static_cast<Package::Type>(m_getFiles->intColumn(2));
-
-    if(!file.type) // < v1.0rc2
-      file.type = entry.type;
-
+    File file;
+    fillFile(m_getFiles, 0, entry, &file);
     files.push_back(file);
     return true;
   });
@@ -288,6 +556,48 @@ auto Registry::getMainFiles(const Entry &entry) const -> vector<File>
   return mainFiles;
 }
 
+void Registry::forEachEntry(const string &remote,
+  const EntryCallback &callback) const
+{
+  m_remoteFiles->bind(1, remote);
+  forEachEntry(m_remoteFiles, callback);
+}
+
+void Registry::forEachEntry(const EntryCallback &callback) const
+{
+  forEachEntry(m_allFiles, callback);
+}
+
+void Registry::forEachEntry(Statement *stmt,
+  const EntryCallback &callback) const
+{
+  // one row per file (or a single row with a NULL path for entries without
+  // any file), the callback is called once all rows of an entry were read
+  Entry entry{};
+  vector<File> files;
+
+  stmt->exec([&] {
+    if(stmt->intColumn(0) != entry.id) {
+      if(entry)
+        callback(entry, files);
+
+      fillEntry(stmt, &entry);
+      files.clear();
+    }
+
+    if(!stmt->isNull(9)) {
+      File file;
+      fillFile(stmt, 9, entry, &file);
+      files.push_back(file);
+    }
+
+    return true;
+  });
+
+  if(entry)
+    callback(entry, files);
+}
+
 void Registry::forget(const Entry &entry)
 {
   m_forgetFiles->bind(1, entry.id);
@@ -295,8 +605,17 @@ void Registry::forget(const Entry &entry)
 
   m_forgetEntry->bind(1, entry.id);
   m_forgetEntry->exec();
+
+  m_forgetRemote->bind(1, entry.remote);
+  m_forgetRemote->exec();
+
+  m_forgetCategory->bind(1, entry.category);
+  m_forgetCategory->exec();
 }
 
+// Savepoint names cannot be bound as parameters: these run without going
+// through the statement cache so they don't evict the useful queries.
+
 void Registry::savepoint()
 {
   char sql[64];
@@ -329,20 +648,88 @@ void Registry::commit()
 void Registry::convertImplicitSections()
 {
   // convert from v1.0 main=true format to v1.1 flag format
+  // (the section of each category is found once, then a single update)
 
-  Statement entries("SELECT id, category FROM entries", &m_db);
-  entries.exec([&] {
-    const auto id = entries.intColumn(0);
-    const string &category = entries.stringColumn(1);
-    const auto section = Source::detectSection(category);
-
-    Statement update("UPDATE files SET main = ? WHERE entry = ? AND main != 0", &m_db);
-    update.bind(1, section);
-    update.bind(2, id);
-    update.exec();
+  vector<string> categories;
 
+  Statement select("SELECT DISTINCT category FROM entries", &m_db);
+  select.exec([&] {
+    categories.push_back(select.stringColumn(0));
     return true;
   });
+
+  m_db.exec(
+    "CREATE TEMP TABLE sections ("
+    "  category TEXT PRIMARY KEY,"
+    "  section INTEGER NOT NULL"
+    ")"
+  );
+
+  {
+    Statement insert("INSERT INTO temp.sections VALUES(?, ?)", &m_db);
+
+    for(const string &category : categories) {
+      insert.bind(1, category);
+      insert.bind(2, Source::detectSection(category));
+      insert.exec();
+    }
+  }
+
+  m_db.exec(
+    "UPDATE files SET main = ("
+    "  SELECT s.section FROM entries e "
+    "  JOIN temp.sections s ON s.category = e.category "
+    "  WHERE e.id = files.entry"
+    ") WHERE main != 0;"
+
+    "DROP TABLE temp.sections;"
+  );
+}
+
+void Registry::normalizeNames()
+{
+  // move remote and category names into lookup tables and index files by
+  // entry. The entries table must be rebuilt for its columns to change type,
+  // row ids are kept so files still point to the right entry.
+
+  m_db.exec(
+    "CREATE TABLE remotes ("
+    "  id INTEGER PRIMARY KEY,"
+    "  name TEXT UNIQUE NOT NULL"
+    ");"
+    "INSERT INTO remotes(name) SELECT DISTINCT remote FROM entries;"
+
+    "CREATE TABLE categories ("
+    "  id INTEGER PRIMARY KEY,"
+    "  name TEXT UNIQUE NOT NULL"
+    ");"
+    "INSERT INTO categories(name) SELECT DISTINCT category FROM entries;"
+
+    "CREATE TABLE entries_new ("
+    "  id INTEGER PRIMARY KEY,"
+    "  remote INTEGER NOT NULL,"
+    "  category INTEGER NOT NULL,"
+    "  package TEXT NOT NULL,"
+    "  desc TEXT NOT NULL,"
+    "  type INTEGER NOT NULL,"
+    "  version TEXT NOT NULL,"
+    "  author TEXT NOT NULL,"
+    "  pinned INTEGER DEFAULT 0,"
+    "  UNIQUE(remote, category, package),"
+    "  FOREIGN KEY(remote) REFERENCES remotes(id),"
+    "  FOREIGN KEY(category) REFERENCES categories(id)"
+    ");"
+    "INSERT INTO entries_new "
+    "  SELECT e.id, r.id, c.id, package, desc, type, version, author, pinned "
+    "  FROM entries e "
+    "  JOIN remotes r ON r.name = e.remote "
+    "  JOIN categories c ON c.name = e.category;"
+
+    "DROP TABLE entries;"
+    "ALTER TABLE entries_new RENAME TO entries;"
+
+    "CREATE INDEX files_entry ON files(entry);"
+  );
 }
 
 void Registry::fillEntry(const Statement *stmt, Entry *entry) const
@@ -359,3 +746,18 @@ void Registry::fillEntry(const Statement *stmt, Entry *entry) const
   entry->author = stmt->stringColumn(col++);
   entry->pinned = stmt->boolColumn(col++);
 }
+
+void Registry::fillFile(const Statement *stmt, int col,
+  const Entry &entry, File *file) const
+{
+  file->path = stmt->stringColumn(col++);
+  file->sections = static_cast<int>(stmt->intColumn(col++));
+  file->type = static_cast<Package::Type>(stmt->intColumn(col++));
+  file->size = stmt->intColumn(col++);
+  file->mtime = stmt->intColumn(col++);
+  file->checksum = static_cast<uint32_t>(stmt->intColumn(col++));
+  file->stored = stmt->boolColumn(col++);
+
+  if(!file->type) // < v1.0rc2
+    file->type = entry.type;
+}
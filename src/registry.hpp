@@ -18,8 +18,10 @@
 #ifndef REAPACK_REGISTRY_HPP
 #define REAPACK_REGISTRY_HPP
 
+#include <functional>
 #include <set>
 #include <string>
+#include <unordered_map>
 
 #include "database.hpp"
 #include "package.hpp"
@@ -48,17 +50,58 @@ public:
     int sections;
     Package::Type type;
 
+    // recorded when the file was installed (size is -1 if unknown)
+    int64_t size;
+    int64_t mtime;
+    uint32_t checksum;
+    bool stored; // hardlinked to the content store
+
+    bool hasManifest() const { return size >= 0; }
+
     bool operator<(const File &o) const { return path < o.path; }
   };
 
-  Registry(const Path &path = {});
+  struct Conflict {
+    const Version *version;
+    Path path;
+    std::string owner; // full name of the package owning the file
+  };
+
+  // Entries loaded in bulk and looked up by remote, category and package
+  // name, instead of querying the database once per package.
+  class EntryMap {
+  public:
+    EntryMap(const std::vector<Entry> &);
+
+    const Entry &find(const Package *) const;
+    size_t size() const { return m_entries.size(); }
+
+  private:
+    std::unordered_map<std::string, Entry> m_entries;
+    Entry m_null;
+  };
+
+  enum Mode {
+    ReadWrite,
+    ReadOnly, // snapshot reader, never waits for or blocks the writer
+  };
+
+  typedef std::function<void (const Entry &, const std::vector<File> &)>
+    EntryCallback;
+
+  Registry(const Path &path = {}, Mode = ReadWrite);
 
   Entry getEntry(const Package *) const;
   std::vector<Entry> getEntries(const std::string &) const;
   std::vector<File> getFiles(const Entry &) const;
   std::vector<File> getMainFiles(const Entry &) const;
-  Entry push(const Version *, std::vector<Path> *conflicts = nullptr);
+  void forEachEntry(const std::string &remote, const EntryCallback &) const;
+  void forEachEntry(const EntryCallback &) const;
+  std::vector<Conflict> conflicts(const std::vector<const Version *> &);
+  Entry push(const Version *);
   void setPinned(const Entry &, bool pinned);
+  void setManifest(const File &);
+  int64_t storeLinks(const File &) const;
   void forget(const Entry &);
   void savepoint();
   void restore();
@@ -66,22 +109,37 @@ public:
   void commit();
 
 private:
+  static std::string key(const std::string &remote,
+    const std::string &cat, const std::string &pkg);
+  static std::string key(const Package *);
+
+  void enableWAL();
+  void checkVersion() const;
   void migrate();
   void convertImplicitSections();
+  void normalizeNames();
+  void forEachEntry(Statement *, const EntryCallback &) const;
   void fillEntry(const Statement *, Entry *) const;
+  void fillFile(const Statement *, int col, const Entry &, File *) const;
 
   Database m_db;
+  Statement *m_insertRemote;
+  Statement *m_insertCategory;
   Statement *m_insertEntry;
   Statement *m_updateEntry;
   Statement *m_setPinned;
   Statement *m_findEntry;
   Statement *m_allEntries;
   Statement *m_forgetEntry;
+  Statement *m_forgetRemote;
+  Statement *m_forgetCategory;
 
   Statement *m_getFiles;
   Statement *m_insertFile;
-  Statement *m_clearFiles;
   Statement *m_forgetFiles;
+  Statement *m_setManifest;
+  Statement *m_remoteFiles;
+  Statement *m_allFiles;
 
   size_t m_savePoint;
 };
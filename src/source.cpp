@@ -19,6 +19,7 @@
 
 #include "errors.hpp"
 #include "index.hpp"
+#include "keyword.hpp"
 
 #include <boost/algorithm/string.hpp>
 
@@ -26,16 +27,42 @@ using namespace std;
 
 auto Source::getSection(const char *name) -> Section
 {
-  if(!strcmp(name, "main"))
-    return MainSection;
-  else if(!strcmp(name, "midi_editor"))
-    return MIDIEditorSection;
-  else if(!strcmp(name, "midi_inline_editor"))
-    return MIDIInlineEditorSection;
-  else if(!strcmp(name, "true"))
-    return ImplicitSection;
-  else
+  return getSection(Keyword(name));
+}
+
+auto Source::getSection(const Keyword &section) -> Section
+{
+  switch(section.hash()) {
+  case KeywordHash("main"):
+    return section == "main" ? MainSection : UnknownSection;
+  case KeywordHash("midi_editor"):
+    return section == "midi_editor" ? MIDIEditorSection : UnknownSection;
+  case KeywordHash("midi_inline_editor"):
+    return section == "midi_inline_editor" ?
+      MIDIInlineEditorSection : UnknownSection;
+  case KeywordHash("true"):
+    return section == "true" ? ImplicitSection : UnknownSection;
+  default:
     return UnknownSection;
+  }
+}
+
+int Source::getSections(const char *list)
+{
+  int sections = 0;
+
+  while(*list) {
+    const size_t size = strcspn(list, "\x20");
+
+    if(size)
+      sections |= getSection(Keyword(list, size));
+
+    list += size;
+    if(*list)
+      list++; // skip the separator
+  }
+
+  return sections;
 }
 
 auto Source::detectSection(const string &category) -> Section
@@ -54,11 +81,33 @@ auto Source::detectSection(const string &category) -> Section
 }
 
 Source::Source(const string &file, const string &url, const Version *ver)
-  : m_type(Package::UnknownType), m_file(file), m_url(url), m_sections(0),
-    m_version(ver)
+  : m_type(Package::UnknownType), m_url(url), m_sections(0), m_version(ver)
 {
   if(m_url.empty())
     throw reapack_error("empty source url");
+
+  const Package *pkg = ver ? ver->package() : nullptr;
+  const Category *cat = pkg ? pkg->category() : nullptr;
+  m_file.assign(file, Index::stringsFor(cat ? cat->index() : nullptr));
+
+  updateTargetPath();
+}
+
+void Source::setTypeOverride(const Package::Type type)
+{
+  m_type = type;
+  updateTargetPath();
+}
+
+void Source::updateTargetPath()
+{
+  // Computed upfront (while the index is loading) instead of on first use
+  // so that the sources of indexes shared between threads and dialogs
+  // are never modified afterwards.
+  const Package *pkg = m_version ? m_version->package() : nullptr;
+
+  if(pkg && pkg->category())
+    m_targetPath = makeTargetPath();
 }
 
 Package::Type Source::type() const
@@ -71,8 +120,8 @@ Package::Type Source::type() const
 
 const string &Source::file() const
 {
-  if(!m_file.empty())
-    return m_file;
+  if(!m_file.str().empty())
+    return m_file.str();
   else
     return m_version->package()->name();
 }
@@ -87,7 +136,7 @@ void Source::setSections(int sections)
   m_sections = sections;
 }
 
-Path Source::targetPath() const
+Path Source::makeTargetPath() const
 {
   Path path;
   const auto type = this->type();
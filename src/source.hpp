@@ -21,7 +21,9 @@
 #include "package.hpp"
 #include "path.hpp"
 #include "platform.hpp"
+#include "stringpool.hpp"
 
+class Keyword;
 class Package;
 class Version;
 
@@ -37,6 +39,7 @@ public:
   };
 
   static Section getSection(const char *);
+  static int getSections(const char *spaceSeparatedList);
   static Section detectSection(const std::string &category);
 
   Source(const std::string &file, const std::string &url, const Version *);
@@ -44,7 +47,7 @@ public:
 
   void setPlatform(Platform p) { m_platform = p; }
   Platform platform() const { return m_platform; }
-  void setTypeOverride(Package::Type t) { m_type = t; }
+  void setTypeOverride(Package::Type);
   Package::Type typeOverride() const { return m_type; }
   Package::Type type() const;
   const std::string &file() const;
@@ -52,12 +55,16 @@ public:
   void setSections(int);
   int sections() const { return m_sections; }
 
-  Path targetPath() const;
+  const Path &targetPath() const { return m_targetPath; }
 
 private:
+  static Section getSection(const Keyword &);
+  void updateTargetPath();
+  Path makeTargetPath() const;
+
   Platform m_platform;
   Package::Type m_type;
-  std::string m_file;
+  PooledString m_file;
   std::string m_url;
   int m_sections;
   Path m_targetPath;
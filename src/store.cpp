@@ -0,0 +1,109 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "store.hpp"
+
+#include "filesystem.hpp"
+
+#include <boost/format.hpp>
+#include <cstring>
+
+using boost::format;
+using namespace std;
+
+Path ContentStore::pathFor(const Registry::File &file)
+{
+  const string &name = (format("%08x-%d") % file.checksum % file.size).str();
+
+  Path path = Path::STORE;
+  path.append(name.substr(0, 2));
+  path.append(name);
+
+  return path;
+}
+
+bool ContentStore::link(Registry::File *file)
+{
+  if(!file->hasManifest())
+    return false;
+
+  const Path &stored = pathFor(*file);
+
+  if(FS::exists(stored)) {
+    // the checksum alone is not enough to tell two files apart
+    if(!sameContents(stored, file->path))
+      return false;
+
+    // replace the file in one step so it's never missing
+    const TempPath paths(file->path);
+
+    if(!FS::link(stored, paths.temp()))
+      return false;
+    else if(!FS::rename(paths)) {
+      FS::remove(paths.temp());
+      return false;
+    }
+  }
+  else if(!FS::link(file->path, stored))
+    return false; // unsupported by the filesystem, keep a regular file
+
+  // all links share the modification time of the stored copy
+  int64_t size;
+  time_t mtime;
+
+  if(FS::stat(file->path, &size, &mtime))
+    file->mtime = mtime;
+
+  file->stored = true;
+
+  return true;
+}
+
+void ContentStore::release(const Registry::File &file)
+{
+  FS::removeRecursive(pathFor(file));
+}
+
+bool ContentStore::sameContents(const Path &a, const Path &b)
+{
+  FILE *fileA = FS::open(a);
+  FILE *fileB = FS::open(b);
+
+  bool same = fileA && fileB;
+
+  char bufferA[16384], bufferB[16384];
+
+  while(same) {
+    const size_t length = fread(bufferA, 1, sizeof(bufferA), fileA);
+
+    if(fread(bufferB, 1, sizeof(bufferB), fileB) != length)
+      same = false;
+    else if(!length)
+      break;
+    else
+      same = !memcmp(bufferA, bufferB, length);
+  }
+
+  same = same && !ferror(fileA) && !ferror(fileB);
+
+  if(fileA)
+    fclose(fileA);
+  if(fileB)
+    fclose(fileB);
+
+  return same;
+}
@@ -0,0 +1,35 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_STORE_HPP
+#define REAPACK_STORE_HPP
+
+#include "registry.hpp"
+
+// Keeps a single copy of identical files installed by different packages,
+// each installed file being a hard link to it.
+class ContentStore {
+public:
+  static Path pathFor(const Registry::File &);
+  static bool link(Registry::File *);
+  static void release(const Registry::File &);
+
+private:
+  static bool sameContents(const Path &, const Path &);
+};
+
+#endif
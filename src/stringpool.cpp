@@ -0,0 +1,48 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stringpool.hpp"
+
+using namespace std;
+
+const string *StringPool::intern(const string &str)
+{
+  return &*m_strings.insert(str).first;
+}
+
+PooledString::PooledString()
+{
+  static const string empty;
+  m_str = &empty;
+}
+
+PooledString::PooledString(const string &str, StringPool *pool)
+{
+  assign(str, pool);
+}
+
+void PooledString::assign(const string &str, StringPool *pool)
+{
+  if(pool) {
+    m_str = pool->intern(str);
+    m_own.reset();
+  }
+  else {
+    m_own = make_unique<string>(str);
+    m_str = m_own.get();
+  }
+}
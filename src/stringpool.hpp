@@ -0,0 +1,54 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_STRINGPOOL_HPP
+#define REAPACK_STRINGPOOL_HPP
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+// Stores a single copy of each distinct string it is given. The returned
+// pointers stay valid until the pool is destroyed, so identical strings
+// interned in the same pool can be compared by address.
+class StringPool {
+public:
+  const std::string *intern(const std::string &);
+  size_t size() const { return m_strings.size(); }
+
+private:
+  std::unordered_set<std::string> m_strings;
+};
+
+// A string interned in a pool, or owned by the holder itself when there is
+// no pool to store it (eg. nodes that don't belong to any index).
+class PooledString {
+public:
+  PooledString();
+  PooledString(const std::string &, StringPool *);
+
+  void assign(const std::string &, StringPool *);
+
+  const std::string &str() const { return *m_str; }
+  const std::string *get() const { return m_str; }
+
+private:
+  const std::string *m_str;
+  std::unique_ptr<std::string> m_own;
+};
+
+#endif
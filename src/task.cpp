@@ -23,7 +23,9 @@
 #include "errors.hpp"
 #include "filesystem.hpp"
 #include "index.hpp"
+#include "store.hpp"
 #include "transaction.hpp"
+#include "verifier.hpp"
 
 using namespace std;
 
@@ -33,8 +35,9 @@ Task::Task(Transaction *tx) : m_tx(tx)
 
 InstallTask::InstallTask(const Version *ver, const bool pin,
     const Registry::Entry &re, const ArchiveReaderPtr &reader, Transaction *tx)
-  : Task(tx), m_version(ver), m_pin(pin), m_oldEntry(move(re)), m_reader(reader),
-    m_fail(false), m_index(ver->package()->category()->index()->shared_from_this())
+  : Task(tx), m_version(ver), m_pin(pin),
+    m_share(tx->config()->install.shareFiles), m_oldEntry(move(re)),
+    m_reader(reader), m_fail(false), m_index(ver->package()->category()->index()->shared_from_this())
 {
 }
 
@@ -43,22 +46,19 @@ bool InstallTask::start()
   // get current files before overwriting the entry
   m_oldFiles = tx()->registry()->getFiles(m_oldEntry);
 
-  // prevent file conflicts (don't worry, the registry push is reverted)
-  try {
-    vector<Path> conflicts;
-    tx()->registry()->push(m_version, &conflicts);
+  // overwritten files may have been the last links to their stored contents
+  copy_if(m_oldFiles.begin(), m_oldFiles.end(), back_inserter(m_storedFiles),
+    [](const Registry::File &f) { return f.stored; });
 
-    if(!conflicts.empty()) {
-      for(const Path &path : conflicts) {
-        tx()->receipt()->addError({"Conflict: " + path.join() +
-          " is already owned by another package", m_version->fullName()});
-      }
+  // prevent file conflicts (looked up for all installations at once)
+  const vector<Registry::Conflict> &conflicts = tx()->conflicts(m_version);
 
-      return false;
+  if(!conflicts.empty()) {
+    for(const Registry::Conflict &conflict : conflicts) {
+      tx()->receipt()->addError({"Conflict: " + conflict.path.join() +
+        " is already owned by " + conflict.owner, m_version->fullName()});
     }
-  }
-  catch(const reapack_error &e) {
-    tx()->receipt()->addError({e.what(), m_version->fullName()});
+
     return false;
   }
 
@@ -76,8 +76,27 @@ bool InstallTask::start()
       push(ex, ex->path());
     }
     else {
+      const string &identity = m_version->fullName();
+      const TempPath paths(targetPath);
+
+      // resume an interrupted transaction that already downloaded this file
+      if(tx()->journal()->adopt(paths, src->url(), identity)) {
+        m_newFiles.push_back(paths);
+        continue;
+      }
+
+      // or continue where its download was interrupted
+      const int64_t received =
+        tx()->journal()->resumable(paths, src->url(), identity);
+
       const NetworkOpts &opts = tx()->config()->network;
       FileDownload *dl = new FileDownload(targetPath, src->url(), opts);
+      dl->setResumeFrom(received);
+      tx()->journal()->plan(paths, src->url(), identity);
+      dl->onFinish([=] {
+        if(dl->state() == ThreadTask::Success)
+          tx()->journal()->staged(paths);
+      });
       push(dl, dl->path());
     }
   }
@@ -99,29 +118,83 @@ void InstallTask::push(ThreadTask *job, const TempPath &path)
   tx()->threadPool()->push(job);
 }
 
-void InstallTask::commit()
+void InstallTask::apply()
 {
   if(m_fail)
     return;
 
   for(const TempPath &paths : m_newFiles) {
     if(!FS::rename(paths)) {
-      tx()->receipt()->addError({"Cannot rename to target: " + FS::lastError(),
-        paths.target().join()});
-
-      // it's a bit late to rollback here as some files might already have been
-      // overwritten. at least we can delete the temporary files
-      rollback();
+      m_renameError = ErrorInfo{"Cannot rename to target: " + FS::lastError(),
+        paths.target().join()};
       return;
     }
   }
 
   for(const Registry::File &file : m_oldFiles) {
     if(FS::remove(file.path))
+      m_removedFiles.insert(file.path);
+  }
+
+  // record what was installed for later integrity checks
+  for(const TempPath &paths : m_newFiles) {
+    Registry::File file{paths.target()};
+
+    if(FileVerifier::record(&file)) {
+      if(m_share)
+        ContentStore::link(&file);
+
+      m_manifests.push_back(file);
+    }
+  }
+}
+
+vector<TempPath> InstallTask::stagedFiles() const
+{
+  if(m_fail)
+    return {};
+
+  return m_newFiles;
+}
+
+void InstallTask::commit()
+{
+  if(m_fail)
+    return;
+  else if(m_renameError) {
+    tx()->receipt()->addError(*m_renameError);
+
+    // it's a bit late to rollback here as some files might already have been
+    // overwritten. at least we can delete the temporary files
+    rollback();
+    return;
+  }
+
+  for(const Registry::File &file : m_oldFiles) {
+    if(m_removedFiles.count(file.path))
       tx()->receipt()->addRemoval(file.path);
+  }
 
-    tx()->registerFile({false, m_oldEntry, file});
+  Registry::Entry newEntry;
+  tx()->registry()->savepoint();
+
+  try {
+    newEntry = tx()->registry()->push(m_version);
+
+    for(const Registry::File &file : m_manifests)
+      tx()->registry()->setManifest(file);
+
+    tx()->registry()->release();
   }
+  catch(const reapack_error &e) {
+    tx()->registry()->restore();
+    tx()->receipt()->addError({e.what(), m_version->fullName()});
+    discard();
+    return;
+  }
+
+  for(const Registry::File &file : m_oldFiles)
+    tx()->registerFile({false, m_oldEntry, file});
 
   InstallTicket::Type type;
 
@@ -132,7 +205,7 @@ void InstallTask::commit()
 
   tx()->receipt()->addTicket({type, m_version, m_oldEntry});
 
-  const Registry::Entry newEntry = tx()->registry()->push(m_version);
+  releaseStoredFiles(m_storedFiles);
 
   if(newEntry.type == Package::ExtensionType)
     tx()->receipt()->setRestartNeeded(true);
@@ -143,6 +216,26 @@ void InstallTask::commit()
   tx()->registerAll(true, newEntry);
 }
 
+void InstallTask::discard()
+{
+  // The files are already in place but the new version could not be
+  // registered. The previous entry is left as it was (a transient error
+  // must not uninstall a working package): the next synchronization will
+  // find it outdated and install the new version again.
+  vector<Registry::File> stored;
+  copy_if(m_manifests.begin(), m_manifests.end(), back_inserter(stored),
+    [](const Registry::File &f) { return f.stored; });
+  releaseStoredFiles(stored);
+
+  m_fail = true;
+}
+
+void InstallTask::releaseStoredFiles(const vector<Registry::File> &files)
+{
+  for(const Registry::File &file : files)
+    tx()->releaseStored(file);
+}
+
 void InstallTask::rollback()
 {
   for(const TempPath &paths : m_newFiles)
@@ -155,13 +248,20 @@ void InstallTask::rollback()
 }
 
 UninstallTask::UninstallTask(const Registry::Entry &re, Transaction *tx)
-  : Task(tx), m_entry(move(re))
+  : Task(tx), m_entry(move(re)), m_hasFiles(false)
+{
+}
+
+UninstallTask::UninstallTask(const Registry::Entry &re,
+    const vector<Registry::File> &files, Transaction *tx)
+  : Task(tx), m_entry(move(re)), m_hasFiles(true), m_files(files)
 {
 }
 
 bool UninstallTask::start()
 {
-  tx()->registry()->getFiles(m_entry).swap(m_files);
+  if(!m_hasFiles)
+    tx()->registry()->getFiles(m_entry).swap(m_files);
 
   // allow conflicting packages to be installed
   tx()->registry()->forget(m_entry);
@@ -169,21 +269,42 @@ bool UninstallTask::start()
   return true;
 }
 
-void UninstallTask::commit()
+void UninstallTask::apply()
 {
   for(const auto &file : m_files) {
     if(!FS::exists(file.path))
       continue;
 
     if(FS::removeRecursive(file.path))
-      tx()->receipt()->addRemoval(file.path);
+      m_removedFiles.insert(file.path);
     else
-      tx()->receipt()->addError({FS::lastError(), file.path.join()});
+      m_failedFiles[file.path] = FS::lastError();
+  }
+}
+
+void UninstallTask::commit()
+{
+  for(const auto &file : m_files) {
+    if(m_removedFiles.count(file.path))
+      tx()->receipt()->addRemoval(file.path);
+    else {
+      const auto it = m_failedFiles.find(file.path);
+      if(it == m_failedFiles.end())
+        continue;
+
+      tx()->receipt()->addError({it->second, file.path.join()});
+    }
 
     tx()->registerFile({false, m_entry, file});
   }
 
   tx()->registry()->forget(m_entry);
+
+  // other packages may still be linked to the same contents
+  for(const auto &file : m_files) {
+    if(file.stored)
+      tx()->releaseStored(file);
+  }
 }
 
 PinTask::PinTask(const Registry::Entry &re, const bool pin, Transaction *tx)
@@ -195,3 +316,54 @@ void PinTask::commit()
 {
   tx()->registry()->setPinned(m_entry, m_pin);
 }
+
+FileSyncer::FileSyncer(const vector<Path> &files)
+  : m_files(files)
+{
+  setSummary("Committing %s: flushing new files to disk");
+}
+
+void FileSyncer::run(DownloadContext *)
+{
+  ThreadNotifier::get()->notify({this, Running});
+
+  if(FS::sync(m_files))
+    finish(Success);
+  else
+    finish(Failure, {FS::lastError(), "Flushing new files to disk"});
+}
+
+FileCommitter::FileCommitter(queue<TaskPtr> tasks, const bool sync)
+  : m_sync(sync)
+{
+  for(; !tasks.empty(); tasks.pop())
+    m_tasks.push_back(tasks.front());
+
+  setSummary("Committing %s: moving files into place");
+}
+
+void FileCommitter::run(DownloadContext *)
+{
+  ThreadNotifier::get()->notify({this, Running});
+
+  // the contents of the new files were already flushed by FileSyncer jobs
+  set<Path> dirs;
+
+  if(m_sync) {
+    for(const TaskPtr &task : m_tasks) {
+      for(const TempPath &paths : task->stagedFiles())
+        dirs.insert(paths.target().dirname());
+    }
+  }
+
+  // not abortable: the files are moved in the same order as the
+  // registry is updated afterwards and must not be left halfway
+  for(const TaskPtr &task : m_tasks)
+    task->apply();
+
+  // then persist the renames, once per directory
+  if(!dirs.empty() && !FS::sync({dirs.begin(), dirs.end()}))
+    finish(Failure, {FS::lastError(), "Flushing directories to disk"});
+  else
+    finish(Success);
+}
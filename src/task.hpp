@@ -18,9 +18,14 @@
 #ifndef REAPACK_TASK_HPP
 #define REAPACK_TASK_HPP
 
+#include "errors.hpp"
 #include "path.hpp"
 #include "registry.hpp"
+#include "thread.hpp"
 
+#include <boost/optional.hpp>
+#include <map>
+#include <queue>
 #include <set>
 #include <unordered_set>
 #include <vector>
@@ -28,12 +33,13 @@
 class ArchiveReader;
 class Index;
 class Source;
-class ThreadTask;
+class Task;
 class Transaction;
 class Version;
 
 typedef std::shared_ptr<ArchiveReader> ArchiveReaderPtr;
 typedef std::shared_ptr<const Index> IndexPtr;
+typedef std::shared_ptr<Task> TaskPtr;
 
 class Task {
 public:
@@ -41,8 +47,12 @@ public:
   virtual ~Task() {}
 
   virtual bool start() { return true; }
+  // called from a worker thread: only touch the filesystem, not tx()
+  virtual void apply() {}
+  virtual std::vector<TempPath> stagedFiles() const { return {}; }
   virtual void commit() = 0;
   virtual void rollback() {}
+  virtual const Version *installs() const { return nullptr; }
 
   bool operator<(const Task &o) { return priority() < o.priority(); }
 
@@ -60,37 +70,53 @@ public:
     const ArchiveReaderPtr &, Transaction *);
 
   bool start() override;
+  void apply() override;
+  std::vector<TempPath> stagedFiles() const override;
   void commit() override;
   void rollback() override;
+  const Version *installs() const override { return m_version; }
 
 private:
   void push(ThreadTask *, const TempPath &);
+  void discard();
+  void releaseStoredFiles(const std::vector<Registry::File> &);
 
   const Version *m_version;
   bool m_pin;
+  bool m_share;
   Registry::Entry m_oldEntry;
   ArchiveReaderPtr m_reader;
 
   bool m_fail;
   IndexPtr m_index; // keep in memory
   std::vector<Registry::File> m_oldFiles;
+  std::vector<Registry::File> m_storedFiles;
   std::vector<TempPath> m_newFiles;
   std::unordered_set<ThreadTask *> m_waiting;
+
+  boost::optional<ErrorInfo> m_renameError;
+  std::set<Path> m_removedFiles;
+  std::vector<Registry::File> m_manifests;
 };
 
 class UninstallTask : public Task {
 public:
   UninstallTask(const Registry::Entry &, Transaction *);
+  UninstallTask(const Registry::Entry &,
+    const std::vector<Registry::File> &, Transaction *);
 
 protected:
   int priority() const override { return 1; }
   bool start() override;
+  void apply() override;
   void commit() override;
 
 private:
   Registry::Entry m_entry;
+  bool m_hasFiles;
   std::vector<Registry::File> m_files;
   std::set<Path> m_removedFiles;
+  std::map<Path, std::string> m_failedFiles;
 };
 
 class PinTask : public Task {
@@ -105,4 +131,30 @@ private:
   bool m_pin;
 };
 
+// flushes the contents of staged files to disk before they replace
+// the installed ones (a batch is split across several of these)
+class FileSyncer : public ThreadTask {
+public:
+  FileSyncer(const std::vector<Path> &);
+
+  bool concurrent() const override { return true; }
+  void run(DownloadContext *) override;
+
+private:
+  std::vector<Path> m_files;
+};
+
+// moves the files of a batch of tasks in place on a worker thread
+class FileCommitter : public ThreadTask {
+public:
+  FileCommitter(std::queue<TaskPtr>, bool sync);
+
+  bool concurrent() const override { return false; }
+  void run(DownloadContext *) override;
+
+private:
+  std::vector<TaskPtr> m_tasks;
+  bool m_sync;
+};
+
 #endif
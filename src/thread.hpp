@@ -115,6 +115,7 @@ public:
   void abort();
 
   bool idle() const { return m_running.empty(); }
+  size_t size() const { return m_pool.size(); }
 
   void onPush(const TaskSignal::slot_type &slot) { m_onPush.connect(slot); }
   void onAbort(const VoidSignal::slot_type &slot) { m_onAbort.connect(slot); }
@@ -17,33 +17,115 @@
 
 #include "time.hpp"
 
-#include <array>
-#include <iomanip>
-#include <sstream>
+#include <ctime>
 
 using namespace std;
 
-Time::Time(const char *iso8601) : m_tm()
+// dates before 1901 were considered invalid when stored as a std::tm
+static const int64_t MIN_VALID = -2177452800; // 1901-01-01T00:00:00Z
+static const int64_t INVALID = INT64_MIN;
+
+// days since 1970-01-01 in the proleptic gregorian calendar
+static int64_t DaysFromCivil(int64_t y, const int m, const int d)
+{
+  y -= m <= 2;
+  const int64_t era = (y >= 0 ? y : y - 399) / 400;
+  const int64_t yoe = y - era * 400;
+  const int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+static void CivilFromDays(int64_t z, int *y, int *m, int *d)
+{
+  z += 719468;
+  const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+  const int64_t doe = z - era * 146097;
+  const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const int64_t mp = (5 * doy + 2) / 153;
+
+  *d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+  *m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+  *y = static_cast<int>(yoe + era * 400 + (*m <= 2));
+}
+
+static bool ReadNumber(const char **p, const int maxDigits, const int min,
+  const int max, const char separator, int *value)
+{
+  *value = 0;
+
+  int digits = 0;
+  for(; digits < maxDigits && **p >= '0' && **p <= '9'; digits++, (*p)++)
+    *value = *value * 10 + (**p - '0');
+
+  if(!digits)
+    return false;
+
+  if(separator) {
+    if(**p != separator)
+      return false;
+
+    (*p)++;
+  }
+
+  return *value >= min && *value <= max;
+}
+
+Time::Time() : m_epoch(INVALID)
 {
-  tm time = {};
+}
 
-  istringstream stream(iso8601);
-  stream >> std::get_time(&time, "%Y-%m-%dT%H:%M:%S");
+Time::Time(const char *iso8601) : m_epoch(INVALID)
+{
+  // YYYY-MM-DDTHH:MM:SS, anything after the seconds (eg. "Z") is ignored
+  // shorter fields are accepted too (eg. 2016-2-3T4:05:06)
+  int year, month, day, hour, minute, second;
+  const char *p = iso8601;
 
-  if(stream.good())
-    swap(m_tm, time);
+  if(ReadNumber(&p, 4, 0, 9999, '-', &year) &&
+      ReadNumber(&p, 2, 1, 12, '-', &month) &&
+      ReadNumber(&p, 2, 1, 31, 'T', &day) &&
+      ReadNumber(&p, 2, 0, 23, ':', &hour) &&
+      ReadNumber(&p, 2, 0, 59, ':', &minute) &&
+      ReadNumber(&p, 2, 0, 60, 0, &second))
+    *this = Time(year, month, day, hour, minute, second);
 }
 
 Time::Time(int year, int month, int day, int hour, int minute, int second)
-  : m_tm()
 {
-  m_tm.tm_year = year - 1900;
-  m_tm.tm_mon = month - 1;
-  m_tm.tm_mday = day;
+  // out of range days are carried over into the next months
+  m_epoch = (DaysFromCivil(year, month, 1) + day - 1) * 86400 +
+    hour * 3600 + minute * 60 + second;
+
+  if(m_epoch < MIN_VALID)
+    m_epoch = INVALID;
+}
+
+bool Time::isValid() const
+{
+  return m_epoch != INVALID;
+}
+
+auto Time::fields() const -> Fields
+{
+  if(!isValid())
+    return {1900, 1, 0, 0, 0, 0};
+
+  int64_t days = m_epoch / 86400, seconds = m_epoch % 86400;
+  if(seconds < 0) {
+    days--;
+    seconds += 86400;
+  }
+
+  Fields fields;
+  CivilFromDays(days, &fields.year, &fields.month, &fields.day);
 
-  m_tm.tm_hour = hour;
-  m_tm.tm_min = minute;
-  m_tm.tm_sec = second;
+  fields.hour = static_cast<int>(seconds / 3600);
+  fields.minute = static_cast<int>(seconds / 60 % 60);
+  fields.second = static_cast<int>(seconds % 60);
+
+  return fields;
 }
 
 string Time::toString() const
@@ -51,19 +133,26 @@ string Time::toString() const
   if(!isValid())
     return {};
 
+  const Fields &fields = this->fields();
+
+  std::tm time = {};
+  time.tm_year = fields.year - 1900;
+  time.tm_mon = fields.month - 1;
+  time.tm_mday = fields.day;
+  time.tm_hour = fields.hour;
+  time.tm_min = fields.minute;
+  time.tm_sec = fields.second;
+
   char buf[32] = {};
-  strftime(buf, sizeof(buf), "%B %d %Y", &m_tm);
+  strftime(buf, sizeof(buf), "%B %d %Y", &time);
   return buf;
 }
 
 int Time::compare(const Time &o) const
 {
-  const array<int, 6> l{year(), month(), day(), hour(), minute(), second()};
-  const array<int, 6> r{o.year(), o.month(), o.day(), o.hour(), o.minute(), o.second()};
-
-  if(l < r)
+  if(m_epoch < o.m_epoch)
     return -1;
-  else if(l > r)
+  else if(m_epoch > o.m_epoch)
     return 1;
 
   return 0;
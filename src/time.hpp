@@ -18,24 +18,25 @@
 #ifndef REAPACK_TIME_HPP
 #define REAPACK_TIME_HPP
 
-#include <ctime>
+#include <cstdint>
 #include <string>
 
 class Time {
 public:
   Time(const char *iso8601);
   Time(int year, int month, int day, int hour = 0, int minute = 0, int second = 0);
-  Time(const std::tm &tm = {}) : m_tm(tm) {}
+  Time();
 
-  bool isValid() const { return m_tm.tm_year > 0; }
+  bool isValid() const;
   operator bool() const { return isValid(); }
 
-  int year() const { return m_tm.tm_year + 1900; }
-  int month() const { return m_tm.tm_mon + 1; }
-  int day() const { return m_tm.tm_mday; }
-  int hour() const { return m_tm.tm_hour; }
-  int minute() const { return m_tm.tm_min; }
-  int second() const { return m_tm.tm_sec; }
+  // seconds since 1970-01-01 00:00:00 UTC
+  int64_t epoch() const { return m_epoch; }
+
+  // broken down calendar date, computed on every call: keep the result
+  // instead of calling this once per field
+  struct Fields { int year, month, day, hour, minute, second; };
+  Fields fields() const;
 
   std::string toString() const;
 
@@ -48,7 +49,7 @@ public:
   bool operator!=(const Time &o) const { return compare(o) != 0; }
 
 private:
-  std::tm m_tm;
+  int64_t m_epoch;
 };
 
 #endif
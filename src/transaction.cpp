@@ -24,7 +24,9 @@
 #include "filesystem.hpp"
 #include "index.hpp"
 #include "remote.hpp"
+#include "store.hpp"
 #include "task.hpp"
+#include "verifier.hpp"
 
 #include <reaper_plugin_functions.h>
 
@@ -33,8 +35,11 @@ using namespace std;
 static const time_t STALE_THRESHOLD = 7 * 24 * 3600;
 
 Transaction::Transaction(Config *config)
-  : m_isCancelled(false), m_config(config),
-    m_registry(Path::prefixRoot(Path::REGISTRY))
+  : m_isCancelled(false), m_filesSynced(false), m_syncFailed(false),
+    m_filesCommitted(false),
+    m_config(config),
+    m_registry(Path::prefixRoot(Path::REGISTRY)),
+    m_journal(Path::prefixRoot(Path::JOURNAL))
 {
   // don't keep pre-install pushes (for conflict checks); released in runTasks
   m_registry.savepoint();
@@ -71,22 +76,44 @@ void Transaction::synchronize(const Remote &remote,
     opts.autoInstall = remote.autoInstall();
 
   fetchIndex(remote, true, [=] (const IndexPtr &ri) {
-    for(const Package *pkg : ri->packages())
-      synchronize(pkg, opts);
+    const vector<Registry::Entry> &entries = m_registry.getEntries(ri->name());
+
+    // installed packages are always checked for missing files
+    unordered_set<const Package *> installed;
+
+    for(const Registry::Entry &entry : entries) {
+      if(const Package *pkg = ri->find(entry.category, entry.package)) {
+        installed.insert(pkg);
+        synchronize(pkg, entry, opts);
+      }
+    }
+
+    if(opts.autoInstall) {
+      // every other package of the repository may need to be installed
+      const Registry::Entry none{};
+
+      for(const Package *pkg : ri->packages()) {
+        if(!installed.count(pkg))
+          synchronize(pkg, none, opts);
+      }
+    }
 
     if(m_config->install.promptObsolete && !remote.isProtected()) {
-      for(const Registry::Entry &entry : m_registry.getEntries(ri->name())) {
+      for(const Registry::Entry &entry : entries) {
         if(!ri->find(entry.category, entry.package))
           m_obsolete.insert(entry);
       }
     }
+
+    // start downloading this repository's packages while other
+    // indexes are still loading
+    startEarly();
   });
 }
 
-void Transaction::synchronize(const Package *pkg, const InstallOpts &opts)
+void Transaction::synchronize(const Package *pkg,
+  const Registry::Entry &regEntry, const InstallOpts &opts)
 {
-  const auto &regEntry = m_registry.getEntry(pkg);
-
   if(!regEntry && !opts.autoInstall)
     return;
 
@@ -107,6 +134,62 @@ void Transaction::synchronize(const Package *pkg, const InstallOpts &opts)
   m_nextQueue.push(make_shared<InstallTask>(latest, false, regEntry, nullptr, this));
 }
 
+void Transaction::repair(const Remote &remote)
+{
+  // check every installed file against its manifest on the worker threads,
+  // then reinstall the packages that were modified or are incomplete
+  fetchIndex(remote, true, [=] (const IndexPtr &ri) {
+    m_registry.forEachEntry(ri->name(), [=] (const Registry::Entry &entry,
+        const vector<Registry::File> &files) {
+      const Package *pkg = ri->find(entry.category, entry.package);
+      const Version *ver = pkg ? pkg->findVersion(entry.version) : nullptr;
+      const auto queued = make_shared<bool>(false);
+
+      for(const Registry::File &file : files) {
+        FileVerifier *job = new FileVerifier(file);
+
+        job->onFinish([=] {
+          if(job->state() != ThreadTask::Success)
+            return;
+
+          switch(job->status()) {
+          case FileVerifier::Intact:
+            break;
+          case FileVerifier::Updated:
+            m_registry.setManifest(job->file());
+            break;
+          case FileVerifier::Modified:
+            // an edit made through one link changed the stored copy shared
+            // with other packages: unlink it so they are reinstalled from
+            // fresh contents instead of being relinked to the edited ones
+            if(job->file().stored)
+              ContentStore::release(job->file());
+            // fallthrough
+          case FileVerifier::Missing:
+            if(*queued)
+              break;
+
+            *queued = true;
+
+            if(ver) {
+              m_nextQueue.push(make_shared<InstallTask>(
+                ver, false, entry, nullptr, this));
+            }
+            else {
+              m_receipt.addError({"Cannot repair " + job->file().path.join() +
+                ": the installed version is no longer available",
+                entry.remote + "/" + entry.category + "/" + entry.package});
+            }
+            break;
+          }
+        });
+
+        m_threadPool.push(job);
+      }
+    });
+  });
+}
+
 void Transaction::fetchIndexes(const vector<Remote> &remotes, const bool stale)
 {
   for(const Remote &remote : remotes)
@@ -129,11 +212,7 @@ vector<IndexPtr> Transaction::getIndexes(const vector<Remote> &remotes) const
 void Transaction::fetchIndex(const Remote &remote, const bool stale,
   const function<void (const IndexPtr &)> &cb)
 {
-  const auto load = [=] {
-    const IndexPtr ri = loadIndex(remote);
-    if(cb && ri)
-      cb(ri);
-  };
+  const auto load = [=] { loadIndex(remote, cb); };
 
   const Path &path = Index::pathFor(remote.name());
   time_t mtime = 0, now = time(nullptr);
@@ -149,6 +228,9 @@ void Transaction::fetchIndex(const Remote &remote, const bool stale,
   dl->setName(remote.name());
 
   dl->onFinish([=] {
+    // the file might be rewritten within the same second with the same size
+    IndexCache::invalidate(remote.name());
+
     if(!dl->save())
       m_receipt.addError({FS::lastError(), dl->path().target().join()});
 
@@ -159,22 +241,42 @@ void Transaction::fetchIndex(const Remote &remote, const bool stale,
   m_threadPool.push(dl);
 }
 
-IndexPtr Transaction::loadIndex(const Remote &remote)
+void Transaction::loadIndex(const Remote &remote,
+  const function<void (const IndexPtr &)> &cb)
 {
   const auto it = m_indexes.find(remote.name());
-  if(it != m_indexes.end())
-    return it->second;
-
-  try {
-    const IndexPtr &ri = Index::load(remote.name());
-    m_indexes[remote.name()] = ri;
-    return ri;
+  if(it != m_indexes.end()) {
+    if(cb)
+      cb(it->second);
+    return;
   }
-  catch(const reapack_error &e) {
-    m_receipt.addError({
-      "Couldn't load repository: " + string(e.what()), remote.name()});
-    return nullptr;
+  else if(const IndexPtr &ri = IndexCache::find(remote.name())) {
+    m_indexes.emplace(remote.name(), ri);
+
+    if(cb)
+      cb(ri);
+    return;
   }
+
+  // parsing errors are added to the receipt by the thread pool's onPush slot
+  IndexLoader *loader = new IndexLoader(remote.name());
+
+  loader->onFinish([=] {
+    if(loader->state() != ThreadTask::Success)
+      return;
+
+    // keep the first copy if the same index was loaded twice concurrently
+    const IndexPtr &ri =
+      m_indexes.emplace(remote.name(), loader->index()).first->second;
+
+    if(loader->stamp().size >= 0 && ri == loader->index())
+      IndexCache::insert(remote.name(), loader->stamp(), ri);
+
+    if(cb)
+      cb(ri);
+  });
+
+  m_threadPool.push(loader);
 }
 
 void Transaction::install(const Version *ver,
@@ -205,14 +307,17 @@ void Transaction::uninstall(const Remote &remote)
   inhibit(remote);
 
   const Path &indexPath = Index::pathFor(remote.name());
+  IndexCache::invalidate(remote.name());
 
   if(FS::exists(indexPath)) {
     if(!FS::remove(indexPath))
       m_receipt.addError({FS::lastError(), indexPath.join()});
   }
 
-  for(const auto &entry : m_registry.getEntries(remote.name()))
-    uninstall(entry);
+  m_registry.forEachEntry(remote.name(),
+    [=] (const Registry::Entry &entry, const vector<Registry::File> &files) {
+      m_nextQueue.push(make_shared<UninstallTask>(entry, files, this));
+    });
 }
 
 void Transaction::uninstall(const Registry::Entry &entry)
@@ -228,8 +333,12 @@ bool Transaction::runTasks()
   }
 
   if(!commitTasks())
-    return false; // we're downloading indexes for synchronization
+    return false; // we're downloading indexes or committing files
   else if(m_isCancelled) {
+    // keep track of the files that were committed before cancellation
+    m_registry.commit();
+    registerQueued();
+
     finish();
     return true;
   }
@@ -239,16 +348,7 @@ bool Transaction::runTasks()
   while(!m_taskQueues.empty()) {
     m_registry.savepoint();
 
-    auto &queue = m_taskQueues.front();
-
-    while(!queue.empty()) {
-      const TaskPtr &task = queue.top();
-
-      if(task->start())
-        m_runningTasks.push(task);
-
-      queue.pop();
-    }
+    startTasks(m_taskQueues.front(), false);
 
     m_registry.restore();
     m_taskQueues.pop();
@@ -266,31 +366,185 @@ bool Transaction::runTasks()
   return true;
 }
 
+void Transaction::startEarly()
+{
+  // tasks queued in earlier batches must be committed first
+  if(m_isCancelled || m_nextQueue.empty() || !m_taskQueues.empty())
+    return;
+
+  TaskQueue queue;
+  swap(queue, m_nextQueue);
+
+  m_registry.savepoint();
+  startTasks(queue, true);
+  m_registry.restore();
+}
+
+void Transaction::startTasks(TaskQueue &queue, const bool early)
+{
+  vector<TaskPtr> installs;
+
+  // installations started since the last commit are not in the registry
+  // yet but already own their files
+  vector<const Version *> versions = m_startedInstalls;
+
+  // uninstallations come first and release their files before
+  // conflicts are looked up for every installation in the queue at once
+  for(; !queue.empty(); queue.pop()) {
+    const TaskPtr &task = queue.top();
+
+    if(const Version *ver = task->installs()) {
+      installs.push_back(task);
+      versions.push_back(ver);
+    }
+    else if(task->start())
+      m_runningTasks.push(task);
+  }
+
+  m_conflicts.clear();
+
+  try {
+    for(Registry::Conflict &conflict : m_registry.conflicts(versions))
+      m_conflicts[conflict.version].push_back(move(conflict));
+  }
+  catch(const reapack_error &e) {
+    for(const TaskPtr &task : installs)
+      m_receipt.addError({e.what(), task->installs()->fullName()});
+
+    return;
+  }
+
+  for(const TaskPtr &task : installs) {
+    const Version *ver = task->installs();
+
+    if(early && !conflicts(ver).empty()) {
+      // try again with the last batch, the files may belong to
+      // obsolete packages that are about to be uninstalled
+      m_nextQueue.push(task);
+    }
+    else if(task->start()) {
+      m_runningTasks.push(task);
+      m_startedInstalls.push_back(ver);
+    }
+  }
+}
+
+auto Transaction::conflicts(const Version *ver) const
+  -> const vector<Registry::Conflict> &
+{
+  static const vector<Registry::Conflict> none;
+
+  const auto it = m_conflicts.find(ver);
+  return it == m_conflicts.end() ? none : it->second;
+}
+
 bool Transaction::commitTasks()
 {
   // wait until all running tasks are ready
   if(!m_threadPool.idle())
     return false;
+  else if(!m_filesCommitted && !m_isCancelled && !m_runningTasks.empty()) {
+    if(!m_filesSynced) {
+      m_filesSynced = true;
+
+      if(m_config->install.syncFiles && syncStagedFiles())
+        return false;
+    }
+
+    // a file that could not be flushed must not replace an installed one:
+    // the whole batch is rolled back below
+    if(!m_syncFailed) {
+      // move the files in place off the main thread, then come back here
+      // to update the registry in the same order once they are all done
+      m_filesCommitted = true;
+      m_threadPool.push(new FileCommitter(m_runningTasks,
+        m_config->install.syncFiles));
+      return false;
+    }
+  }
 
   // finish current tasks
   while(!m_runningTasks.empty()) {
-    if(m_isCancelled)
-      m_runningTasks.front()->rollback();
-    else
+    if(m_filesCommitted)
       m_runningTasks.front()->commit();
+    else
+      m_runningTasks.front()->rollback();
 
     m_runningTasks.pop();
   }
 
+  m_filesSynced = false;
+  m_syncFailed = false;
+  m_filesCommitted = false;
+  m_startedInstalls.clear();
+
+  return true;
+}
+
+bool Transaction::syncStagedFiles()
+{
+  // flush the contents of every new file before any of them replaces an
+  // installed file, so a crash cannot leave truncated files behind
+  vector<Path> files;
+
+  for(queue<TaskPtr> tasks = m_runningTasks; !tasks.empty(); tasks.pop()) {
+    for(const TempPath &paths : tasks.front()->stagedFiles())
+      files.push_back(paths.temp());
+  }
+
+  if(files.empty())
+    return false;
+
+  // each flush waits for the disk: spread them across the worker threads
+  // so the device can process them concurrently
+  const size_t jobs = min(files.size(), m_threadPool.size());
+  const size_t perJob = (files.size() + jobs - 1) / jobs;
+
+  for(auto it = files.begin(); it != files.end(); ) {
+    const auto end = it + min<size_t>(perJob, files.end() - it);
+    FileSyncer *job = new FileSyncer({it, end});
+    job->onFinish([=] {
+      if(job->state() != ThreadTask::Success)
+        m_syncFailed = true;
+    });
+
+    m_threadPool.push(job);
+    it = end;
+  }
+
   return true;
 }
 
 void Transaction::finish()
 {
+  // staged files left over by an interrupted transaction were either
+  // adopted by this one or are not wanted anymore
+  m_journal.purge();
+
+  releaseStoredFiles();
+
   m_onFinish();
   m_cleanupHandler();
 }
 
+void Transaction::releaseStoredFiles()
+{
+  // Done once every task of every batch is committed: an install later in
+  // the same batch may have linked a new file to a stored copy that an
+  // earlier uninstall or upgrade no longer uses.
+  for(const Registry::File &file : m_storeReleases) {
+    try {
+      if(!m_registry.storeLinks(file))
+        ContentStore::release(file);
+    }
+    catch(const reapack_error &) {
+      // keep the stored copy if it might still be in use
+    }
+  }
+
+  m_storeReleases.clear();
+}
+
 bool Transaction::allFilesExists(const set<Path> &list) const
 {
   for(const Path &path : list) {
@@ -18,6 +18,7 @@
 #ifndef REAPACK_TRANSACTION_HPP
 #define REAPACK_TRANSACTION_HPP
 
+#include "journal.hpp"
 #include "receipt.hpp"
 #include "registry.hpp"
 #include "task.hpp"
@@ -28,6 +29,7 @@
 #include <functional>
 #include <memory>
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
 
 class ArchiveReader;
@@ -36,8 +38,6 @@ class Path;
 class Remote;
 struct InstallOpts;
 
-typedef std::shared_ptr<Task> TaskPtr;
-
 struct HostTicket { bool add; Registry::Entry entry; Registry::File file; };
 
 class Transaction {
@@ -56,6 +56,7 @@ public:
   std::vector<IndexPtr> getIndexes(const std::vector<Remote> &) const;
   void synchronize(const Remote &,
     boost::optional<bool> forceAutoInstall = boost::none);
+  void repair(const Remote &);
   void install(const Version *, bool pin = false, const ArchiveReaderPtr & = nullptr);
   void setPinned(const Registry::Entry &, bool pinned);
   void uninstall(const Remote &);
@@ -67,11 +68,14 @@ public:
 
   Receipt *receipt() { return &m_receipt; }
   Registry *registry() { return &m_registry; }
+  Journal *journal() { return &m_journal; }
+  const std::vector<Registry::Conflict> &conflicts(const Version *) const;
   const Config *config() { return m_config; }
   ThreadPool *threadPool() { return &m_threadPool; }
 
   void registerAll(bool add, const Registry::Entry &);
   void registerFile(const HostTicket &t) { m_regQueue.push(t); }
+  void releaseStored(const Registry::File &f) { m_storeReleases.push_back(f); }
 
 private:
   class CompareTask {
@@ -87,30 +91,43 @@ private:
 
   void fetchIndex(const Remote &, bool stale,
     const std::function<void (const IndexPtr &)> & = {});
-  IndexPtr loadIndex(const Remote &);
-  void synchronize(const Package *, const InstallOpts &);
+  void loadIndex(const Remote &, const std::function<void (const IndexPtr &)> &);
+  void synchronize(const Package *, const Registry::Entry &,
+    const InstallOpts &);
   bool allFilesExists(const std::set<Path> &) const;
   void registerQueued();
+  void releaseStoredFiles();
   void registerScript(const HostTicket &, bool isLast);
   void inhibit(const Remote &);
   void promptObsolete();
+  void startEarly();
+  void startTasks(TaskQueue &, bool early);
   bool commitTasks();
+  bool syncStagedFiles();
   void finish();
 
   bool m_isCancelled;
+  bool m_filesSynced;
+  bool m_syncFailed;
+  bool m_filesCommitted;
   const Config *m_config;
   Registry m_registry;
+  Journal m_journal;
   Receipt m_receipt;
 
   std::unordered_set<std::string> m_syncedRemotes;
   std::map<std::string, IndexPtr> m_indexes;
   std::unordered_set<std::string> m_inhibited;
   std::unordered_set<Registry::Entry> m_obsolete;
+  std::vector<Registry::File> m_storeReleases;
 
   ThreadPool m_threadPool;
   TaskQueue m_nextQueue;
   std::queue<TaskQueue> m_taskQueues;
   std::queue<TaskPtr> m_runningTasks;
+  std::vector<const Version *> m_startedInstalls;
+  std::unordered_map<const Version *,
+    std::vector<Registry::Conflict> > m_conflicts;
   std::queue<HostTicket> m_regQueue;
 
   VoidSignal m_onFinish;
@@ -0,0 +1,86 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "verifier.hpp"
+
+#include "filesystem.hpp"
+
+using namespace std;
+
+auto FileVerifier::verify(Registry::File *file) -> Status
+{
+  int64_t size;
+  time_t mtime;
+
+  if(!FS::stat(file->path, &size, &mtime))
+    return Missing;
+  else if(file->hasManifest()) {
+    if(size != file->size)
+      return Modified;
+    else if(mtime == file->mtime)
+      return Intact; // fast path, the contents are not read
+  }
+
+  // the metadata changed (or was never recorded): only the contents can tell
+  uint32_t checksum;
+
+  if(!FS::checksum(file->path, &checksum))
+    return Missing;
+  else if(file->hasManifest() && checksum != file->checksum)
+    return Modified;
+
+  file->size = size;
+  file->mtime = mtime;
+  file->checksum = checksum;
+
+  return Updated;
+}
+
+bool FileVerifier::record(Registry::File *file)
+{
+  time_t mtime;
+
+  if(!FS::stat(file->path, &file->size, &mtime) ||
+      !FS::checksum(file->path, &file->checksum)) {
+    file->size = -1;
+    return false;
+  }
+
+  file->mtime = mtime;
+
+  return true;
+}
+
+FileVerifier::FileVerifier(const Registry::File &file)
+  : m_file(file), m_status(Missing)
+{
+  setSummary("Verifying %s: " + file.path.join());
+}
+
+void FileVerifier::run(DownloadContext *)
+{
+  if(aborted()) {
+    finish(Aborted, {"cancelled", m_file.path.join()});
+    return;
+  }
+
+  ThreadNotifier::get()->notify({this, Running});
+
+  m_status = verify(&m_file);
+
+  finish(Success);
+}
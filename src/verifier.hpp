@@ -0,0 +1,49 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_VERIFIER_HPP
+#define REAPACK_VERIFIER_HPP
+
+#include "registry.hpp"
+#include "thread.hpp"
+
+class FileVerifier : public ThreadTask {
+public:
+  enum Status {
+    Intact,   // matches the recorded manifest
+    Updated,  // contents are unchanged (or unknown), the manifest is outdated
+    Modified,
+    Missing,
+  };
+
+  static Status verify(Registry::File *);
+  static bool record(Registry::File *);
+
+  FileVerifier(const Registry::File &);
+
+  const Registry::File &file() const { return m_file; }
+  Status status() const { return m_status; }
+
+  bool concurrent() const override { return true; }
+  void run(DownloadContext *) override;
+
+private:
+  Registry::File m_file;
+  Status m_status;
+};
+
+#endif
@@ -18,12 +18,12 @@
 #include "version.hpp"
 
 #include "errors.hpp"
+#include "index.hpp"
 #include "package.hpp"
 #include "source.hpp"
 
-#include <boost/lexical_cast.hpp>
-#include <cctype>
-#include <regex>
+#include <cstring>
+#include <limits>
 
 using boost::format;
 using namespace std;
@@ -39,12 +39,18 @@ string Version::displayAuthor(const string &author)
 Version::Version(const string &str, const Package *pkg)
   : m_name(str), m_time(), m_package(pkg)
 {
+  setAuthor({});
 }
 
-Version::~Version()
+const Index *Version::index() const
 {
-  for(const Source *source : m_sources)
-    delete source;
+  const Category *cat = m_package ? m_package->category() : nullptr;
+  return cat ? cat->index() : nullptr;
+}
+
+void Version::setAuthor(const string &author)
+{
+  m_author.assign(author, Index::stringsFor(index()));
 }
 
 string Version::fullName() const
@@ -63,7 +69,7 @@ bool Version::addSource(const Source *source)
   else if(!source->platform().test())
     return false;
 
-  const Path path = source->targetPath();
+  const Path &path = source->targetPath();
 
   if(m_files.count(path))
     return false;
@@ -74,55 +80,89 @@ bool Version::addSource(const Source *source)
   return true;
 }
 
-VersionName::VersionName() : m_stable(true)
+// Segments are encoded so that comparing two keys byte by byte gives the
+// same ordering as comparing the versions segment by segment:
+// letters < zero < numbers, and letters are terminated by a null byte.
+// Trailing zeros are omitted so that 1 and 1.0 have the same key.
+enum SegmentTag : char {
+  LettersTag = 1,
+  ZeroTag    = 2,
+  NumberTag  = 3,
+};
+
+VersionName::VersionName() : m_size(0), m_stable(true)
 {}
 
 VersionName::VersionName(const string &str)
+  : VersionName()
 {
   parse(str);
 }
 
 VersionName::VersionName(const VersionName &o)
-  : m_string(o.m_string), m_segments(o.m_segments), m_stable(o.m_stable)
+  : m_string(o.m_string), m_key(o.m_key), m_size(o.m_size),
+    m_stable(o.m_stable)
 {
 }
 
 void VersionName::parse(const string &str)
 {
-  static const regex pattern("\\d+|[a-zA-Z]+");
+  const auto isDigit = [] (const char c) { return c >= '0' && c <= '9'; };
+  const auto isLetter = [] (const char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+  };
 
-  const auto &begin = sregex_iterator(str.begin(), str.end(), pattern);
-  const sregex_iterator end;
+  string key;
+  size_t segments = 0, letters = 0, significant = 0;
 
-  size_t letters = 0;
-  vector<Segment> segments;
+  for(const char *p = str.c_str(); *p;) {
+    if(isDigit(*p)) {
+      unsigned int value = 0;
 
-  for(sregex_iterator it = begin; it != end; it++) {
-    const string match = it->str(0);
-    const char first = tolower(match[0]);
+      for(; isDigit(*p); p++) {
+        value = value * 10 + (*p - '0');
 
-    if(first >= 'a' || first >= 'z') {
-      if(segments.empty()) // got leading letters
+        if(value > numeric_limits<Numeric>::max())
+          throw reapack_error(format("version segment overflow in '%s'") % str);
+      }
+
+      if(value) {
+        key += NumberTag;
+        key += static_cast<char>(value >> 8);
+        key += static_cast<char>(value & 0xff);
+        significant = key.size();
+      }
+      else
+        key += ZeroTag;
+    }
+    else if(isLetter(*p)) {
+      if(!segments) // got leading letters
         throw reapack_error(format("invalid version name '%s'") % str);
 
-      segments.push_back(match);
+      key += LettersTag;
+      for(; isLetter(*p); p++)
+        key += *p;
+      key += '\0';
+
+      significant = key.size();
       letters++;
     }
     else {
-      try {
-        segments.push_back(boost::lexical_cast<Numeric>(match));
-      }
-      catch(const boost::bad_lexical_cast &) {
-        throw reapack_error(format("version segment overflow in '%s'") % str);
-      }
+      p++;
+      continue;
     }
+
+    segments++;
   }
 
-  if(segments.empty()) // version doesn't have any numbers
+  if(!segments) // version doesn't have any numbers
     throw reapack_error(format("invalid version name '%s'") % str);
 
+  key.resize(significant);
+
   m_string = str;
-  swap(m_segments, segments);
+  swap(m_key, key);
+  m_size = segments;
   m_stable = letters < 1;
 }
 
@@ -137,51 +177,31 @@ bool VersionName::tryParse(const string &str)
   }
 }
 
-auto VersionName::segment(const size_t index) const -> Segment
-{
-  if(index < size())
-    return m_segments[index];
-  else
-    return 0;
-}
-
 int VersionName::compare(const VersionName &o) const
 {
-  const size_t biggest = max(size(), o.size());
-
-  switch(m_segments.empty() + o.m_segments.empty()) {
+  switch((m_size == 0) + (o.m_size == 0)) {
   case 1:
-    return m_segments.empty() ? -1 : 1;
+    return m_size == 0 ? -1 : 1;
   case 2:
     return 0;
   }
 
-  for(size_t i = 0; i < biggest; i++) {
-    const Segment &lseg = segment(i);
-    const Numeric *lnum = boost::get<Numeric>(&lseg);
-    const string *lstr = boost::get<string>(&lseg);
+  const size_t common = min(m_key.size(), o.m_key.size());
 
-    const Segment &rseg = o.segment(i);
-    const Numeric *rnum = boost::get<Numeric>(&rseg);
-    const string *rstr = boost::get<string>(&rseg);
+  if(const int diff = memcmp(m_key.data(), o.m_key.data(), common))
+    return diff < 0 ? -1 : 1;
+  else if(m_key.size() == o.m_key.size())
+    return 0;
 
-    if(lnum && rnum) {
-      if(*lnum < *rnum)
-        return -1;
-      else if(*lnum > *rnum)
-        return 1;
-    }
-    else if(lstr && rstr) {
-      if(*lstr < *rstr)
-        return -1;
-      else if(*lstr > *rstr)
-        return 1;
-    }
-    else if(lnum && rstr)
-      return 1;
-    else if(lstr && rnum)
-      return -1;
-  }
+  // The shorter key is followed by implicit zeros. The longer one is bigger
+  // if its next significant segment is a number, and smaller if it is letters.
+  const bool isLonger = m_key.size() > o.m_key.size();
+  const string &longer = isLonger ? m_key : o.m_key;
+
+  size_t i = common;
+  while(longer[i] == ZeroTag)
+    i++;
 
-  return 0;
+  const int sign = longer[i] == NumberTag ? 1 : -1;
+  return isLonger ? sign : -sign;
 }
@@ -18,17 +18,19 @@
 #ifndef REAPACK_VERSION_HPP
 #define REAPACK_VERSION_HPP
 
-#include <boost/variant.hpp>
+#include <boost/utility/string_view.hpp>
 #include <cstdint>
 #include <map>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "path.hpp"
+#include "stringpool.hpp"
 #include "time.hpp"
 
+class Index;
 class Package;
-class Path;
 class Source;
 
 class VersionName {
@@ -40,7 +42,7 @@ public:
   void parse(const std::string &);
   bool tryParse(const std::string &);
 
-  size_t size() const { return m_segments.size(); }
+  size_t size() const { return m_size; }
   bool isStable() const { return m_stable; }
   const std::string &toString() const { return m_string; }
 
@@ -54,12 +56,11 @@ public:
 
 private:
   typedef uint16_t Numeric;
-  typedef boost::variant<Numeric, std::string> Segment;
-
-  Segment segment(size_t i) const;
 
   std::string m_string;
-  std::vector<Segment> m_segments;
+  // segments packed in a byte string ordered like the version numbers
+  std::string m_key;
+  size_t m_size;
   bool m_stable;
 };
 
@@ -68,21 +69,24 @@ public:
   static std::string displayAuthor(const std::string &name);
 
   Version(const std::string &, const Package *);
-  ~Version();
 
   const VersionName &name() const { return m_name; }
   const Package *package() const { return m_package; }
   std::string fullName() const;
 
-  void setAuthor(const std::string &author) { m_author = author; }
-  const std::string &author() const { return m_author; }
-  std::string displayAuthor() const { return displayAuthor(m_author); }
+  void setAuthor(const std::string &);
+  const std::string &author() const { return m_author.str(); }
+  std::string displayAuthor() const { return displayAuthor(author()); }
 
   void setTime(const Time &time) { if(time) m_time = time; }
   const Time &time() const { return m_time; }
 
-  void setChangelog(const std::string &cl) { m_changelog = cl; }
-  const std::string &changelog() const { return m_changelog; }
+  void setChangelog(const std::string &cl)
+    { m_changelog = cl; m_changelogRef = {}; }
+  // the text must outlive the version (eg. in the arena of its index)
+  void setChangelogRef(boost::string_view cl) { m_changelogRef = cl; }
+  boost::string_view changelog() const
+    { return m_changelogRef.data() ? m_changelogRef : m_changelog; }
 
   bool addSource(const Source *source);
   const auto &sources() const { return m_sources; }
@@ -91,9 +95,12 @@ public:
   const std::set<Path> &files() const { return m_files; }
 
 private:
+  const Index *index() const;
+
   VersionName m_name;
-  std::string m_author;
+  PooledString m_author;
   std::string m_changelog;
+  boost::string_view m_changelogRef;
   Time m_time;
   const Package *m_package;
   std::vector<const Source *> m_sources;
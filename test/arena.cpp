@@ -0,0 +1,87 @@
+#include <catch.hpp>
+
+#include <arena.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const char *M = "[arena]";
+
+TEST_CASE("arena allocation alignment", M) {
+  Arena arena(64);
+
+  for(int i = 0; i < 10; i++) {
+    arena.allocate(1, 1);
+    const uintptr_t ptr = reinterpret_cast<uintptr_t>(arena.allocate(8, 8));
+    REQUIRE(ptr % 8 == 0);
+  }
+}
+
+TEST_CASE("arena block reuse", M) {
+  Arena arena(64);
+  REQUIRE(arena.empty());
+
+  arena.allocate(16, 1);
+  REQUIRE(arena.blockCount() == 1);
+
+  arena.allocate(16, 1);
+  REQUIRE(arena.blockCount() == 1);
+
+  SECTION("new block when full") {
+    arena.allocate(48, 1);
+    REQUIRE(arena.blockCount() == 2);
+  }
+
+  SECTION("oversized allocation") {
+    arena.allocate(1024, 1);
+    REQUIRE(arena.blockCount() == 2);
+
+    arena.allocate(16, 1); // still fits in the first block
+    REQUIRE(arena.blockCount() == 2);
+  }
+}
+
+TEST_CASE("arena object construction", M) {
+  Arena arena;
+  const string *str = arena.make<string>(100, 'x');
+  REQUIRE(*str == string(100, 'x'));
+
+  const int *num = arena.make<int>(42);
+  REQUIRE(*num == 42);
+}
+
+TEST_CASE("arena destruction order", M) {
+  struct Tracker {
+    Tracker(int id, vector<int> *log) : m_id(id), m_log(log) {}
+    ~Tracker() { m_log->push_back(m_id); }
+
+    int m_id;
+    vector<int> *m_log;
+  };
+
+  vector<int> log;
+
+  {
+    Arena arena;
+    arena.make<Tracker>(1, &log);
+    arena.make<Tracker>(2, &log);
+    arena.make<Tracker>(3, &log);
+    REQUIRE(log.empty());
+  }
+
+  REQUIRE(log == vector<int>{3, 2, 1});
+}
+
+TEST_CASE("arena string copy", M) {
+  Arena arena;
+  char buf[] = "hello";
+  const char *copy = arena.copy(buf);
+  buf[0] = 'j';
+
+  REQUIRE(copy != buf);
+  REQUIRE(string(copy) == "hello");
+  REQUIRE(string(arena.copy("")).empty());
+}
@@ -227,3 +227,41 @@ TEST_CASE("invalid string column", M) {
     return false;
   });
 }
+
+TEST_CASE("cached statements", M) {
+  Database db;
+  db.exec("CREATE TABLE test (value INTEGER NOT NULL);");
+
+  StatementPtr insert = db.cached("INSERT INTO test VALUES (?)");
+  REQUIRE(db.cached("INSERT INTO test VALUES (?)") == insert);
+
+  insert->bind(1, 42);
+  insert->exec();
+
+  int64_t value = 0;
+  StatementPtr select = db.cached("SELECT value FROM test");
+  select->exec([&] {
+    value = select->intColumn(0);
+    return false;
+  });
+
+  REQUIRE(value == 42);
+  REQUIRE(select != insert);
+  REQUIRE(db.cached("INSERT INTO test VALUES (?)") == insert);
+
+  SECTION("invalid sql") {
+    REQUIRE_THROWS_AS(db.cached("WHERE"), reapack_error);
+  }
+
+  SECTION("evicted statement stays usable") {
+    for(int i = 0; i < 32; i++)
+      db.cached("SELECT " + to_string(i));
+
+    REQUIRE(db.cached("INSERT INTO test VALUES (?)") != insert);
+
+    insert->bind(1, 43);
+    insert->exec();
+
+    REQUIRE(db.lastInsertId() == 2);
+  }
+}
@@ -21,4 +21,26 @@ TEST_CASE("unicode filename", M) {
     time_t time;
     REQUIRE(FS::mtime(path, &time));
   }
+
+  SECTION("FS::stat") {
+    int64_t size;
+    time_t time;
+    REQUIRE(FS::stat(path, &size, &time));
+    REQUIRE(size == 21);
+  }
+
+  SECTION("FS::checksum") {
+    uint32_t checksum;
+    REQUIRE(FS::checksum(path, &checksum));
+    REQUIRE(checksum == 0x8fd0d4de);
+  }
+
+  SECTION("FS::sync") {
+    REQUIRE(FS::sync({path, path.dirname()}));
+  }
+}
+
+TEST_CASE("sync missing file", M) {
+  UseRootPath root(RIPATH);
+  REQUIRE_FALSE(FS::sync({Path("404.xml")}));
 }
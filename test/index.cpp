@@ -89,10 +89,10 @@ TEST_CASE("future version", M) {
 
 TEST_CASE("add a category", M) {
   Index ri("a");
-  Category *cat = new Category("a", &ri);
-  Package *pack = new Package(Package::ScriptType, "name", cat);
-  Version *ver = new Version("1", pack);
-  Source *source = new Source({}, "google.com", ver);
+  Category *cat = ri.arena()->make<Category>("a", &ri);
+  Package *pack = ri.arena()->make<Package>(Package::ScriptType, "name", cat);
+  Version *ver = ri.arena()->make<Version>("1", pack);
+  Source *source = ri.arena()->make<Source>(string(), "google.com", ver);
 
   ver->addSource(source);
   pack->addVersion(ver);
@@ -112,14 +112,13 @@ TEST_CASE("add owned category", M) {
   Index ri1("a");
   Index ri2("b");
 
-  Category *cat = new Category("name", &ri1);
+  Category *cat = ri1.arena()->make<Category>("name", &ri1);
 
   try {
     ri2.addCategory(cat);
     FAIL();
   }
   catch(const reapack_error &e) {
-    delete cat;
     REQUIRE(string(e.what()) == "category belongs to another index");
   }
 }
@@ -135,9 +134,9 @@ TEST_CASE("drop empty category", M) {
 TEST_CASE("add a package", M) {
   Index ri("a");
   Category cat("a", &ri);
-  Package *pack = new Package(Package::ScriptType, "name", &cat);
-  Version *ver = new Version("1", pack);
-  ver->addSource(new Source({}, "google.com", ver));
+  Package *pack = ri.arena()->make<Package>(Package::ScriptType, "name", &cat);
+  Version *ver = ri.arena()->make<Version>("1", pack);
+  ver->addSource(ri.arena()->make<Source>(string(), "google.com", ver));
   pack->addVersion(ver);
 
   CHECK(cat.packages().size() == 0);
@@ -151,8 +150,9 @@ TEST_CASE("add a package", M) {
 }
 
 TEST_CASE("add owned package", M) {
+  Arena arena;
   Category cat1("a", nullptr);
-  Package *pack = new Package(Package::ScriptType, "name", &cat1);
+  Package *pack = arena.make<Package>(Package::ScriptType, "name", &cat1);
 
   try {
     Category cat2("b", nullptr);
@@ -160,7 +160,6 @@ TEST_CASE("add owned package", M) {
     FAIL();
   }
   catch(const reapack_error &e) {
-    delete pack;
     REQUIRE(string(e.what()) == "package belongs to another category");
   }
 }
@@ -217,10 +216,10 @@ TEST_CASE("set index name", M) {
 
 TEST_CASE("find package", M) {
   Index ri("index name");
-  Category *cat = new Category("cat", &ri);
-  Package *pack = new Package(Package::ScriptType, "pkg", cat);
-  Version *ver = new Version("1", pack);
-  Source *source = new Source({}, "google.com", ver);
+  Category *cat = ri.arena()->make<Category>("cat", &ri);
+  Package *pack = ri.arena()->make<Package>(Package::ScriptType, "pkg", cat);
+  Version *ver = ri.arena()->make<Version>("1", pack);
+  Source *source = ri.arena()->make<Source>(string(), "google.com", ver);
 
   ver->addSource(source);
   pack->addVersion(ver);
@@ -231,3 +230,173 @@ TEST_CASE("find package", M) {
   REQUIRE(ri.find("cat", "b") == nullptr);
   REQUIRE(ri.find("cat", "pkg") == pack);
 }
+
+TEST_CASE("diff identical indexes", M) {
+  const char *xml =
+    "<index version=\"1\"><category name=\"cat\">"
+    "<reapack name=\"pkg\" type=\"script\">"
+    "<version name=\"1.0\"><source>http://a</source></version>"
+    "</reapack></category></index>";
+
+  IndexPtr before = Index::load("", xml), after = Index::load("", xml);
+  const IndexDiff diff(before.get(), after.get());
+
+  REQUIRE(diff.empty());
+  REQUIRE(diff.added().empty());
+  REQUIRE(diff.removed().empty());
+  REQUIRE(diff.changed().empty());
+  REQUIRE_FALSE(diff.metadataChanged());
+
+  REQUIRE(diff.unchanged().size() == 1);
+  REQUIRE(diff.unchanged()[0].first == before->find("cat", "pkg"));
+  REQUIRE(diff.unchanged()[0].second == after->find("cat", "pkg"));
+}
+
+TEST_CASE("diff modified indexes", M) {
+  IndexPtr before = Index::load("",
+    "<index version=\"1\">"
+    "<category name=\"a\">"
+    "<reapack name=\"same\" type=\"script\">"
+    "<version name=\"1.0\"><source>http://a</source></version></reapack>"
+    "<reapack name=\"changed\" type=\"script\">"
+    "<version name=\"1.0\"><source>http://a</source></version></reapack>"
+    "<reapack name=\"removed\" type=\"script\">"
+    "<version name=\"1.0\"><source>http://a</source></version></reapack>"
+    "</category>"
+    "<category name=\"old\">"
+    "<reapack name=\"pkg\" type=\"script\">"
+    "<version name=\"1.0\"><source>http://a</source></version></reapack>"
+    "</category></index>");
+
+  IndexPtr after = Index::load("",
+    "<index version=\"1\">"
+    "<category name=\"a\">"
+    "<reapack name=\"same\" type=\"script\">"
+    "<version name=\"1.0\"><source>http://a</source></version></reapack>"
+    "<reapack name=\"changed\" type=\"script\">"
+    "<version name=\"1.0\"><source>http://a</source></version>"
+    "<version name=\"1.1\"><source>http://b</source></version></reapack>"
+    "<reapack name=\"added\" type=\"script\">"
+    "<version name=\"1.0\"><source>http://a</source></version></reapack>"
+    "</category>"
+    "<category name=\"new\">"
+    "<reapack name=\"pkg\" type=\"script\">"
+    "<version name=\"1.0\"><source>http://a</source></version></reapack>"
+    "</category></index>");
+
+  const IndexDiff diff(before.get(), after.get());
+  REQUIRE_FALSE(diff.empty());
+
+  REQUIRE(diff.added().size() == 2);
+  REQUIRE(diff.added()[0] == after->find("a", "added"));
+  REQUIRE(diff.added()[1] == after->find("new", "pkg"));
+
+  REQUIRE(diff.removed().size() == 2);
+  REQUIRE(diff.removed()[0] == before->find("a", "removed"));
+  REQUIRE(diff.removed()[1] == before->find("old", "pkg"));
+
+  REQUIRE(diff.changed().size() == 1);
+  REQUIRE(diff.changed()[0].first == before->find("a", "changed"));
+  REQUIRE(diff.changed()[0].second == after->find("a", "changed"));
+
+  REQUIRE(diff.unchanged().size() == 1);
+  REQUIRE(diff.unchanged()[0].second == after->find("a", "same"));
+
+  REQUIRE(diff.addedCategories().size() == 1);
+  REQUIRE(diff.addedCategories()[0]->name() == "new");
+  REQUIRE(diff.removedCategories().size() == 1);
+  REQUIRE(diff.removedCategories()[0]->name() == "old");
+}
+
+TEST_CASE("diff source and metadata changes", M) {
+  IndexPtr before = Index::load("",
+    "<index version=\"1\"><category name=\"cat\">"
+    "<reapack name=\"pkg\" type=\"script\">"
+    "<version name=\"1.0\"><source>http://a</source></version>"
+    "</reapack></category></index>");
+
+  SECTION("source url") {
+    IndexPtr after = Index::load("",
+      "<index version=\"1\"><category name=\"cat\">"
+      "<reapack name=\"pkg\" type=\"script\">"
+      "<version name=\"1.0\"><source>http://b</source></version>"
+      "</reapack></category></index>");
+
+    const IndexDiff diff(before.get(), after.get());
+    REQUIRE(diff.changed().size() == 1);
+  }
+
+  SECTION("index metadata") {
+    IndexPtr after = Index::load("",
+      "<index version=\"1\"><category name=\"cat\">"
+      "<reapack name=\"pkg\" type=\"script\">"
+      "<version name=\"1.0\"><source>http://a</source></version>"
+      "</reapack></category>"
+      "<metadata><description>Hello</description></metadata></index>");
+
+    const IndexDiff diff(before.get(), after.get());
+    REQUIRE(diff.changed().empty());
+    REQUIRE(diff.metadataChanged());
+    REQUIRE_FALSE(diff.empty());
+  }
+}
+
+TEST_CASE("index cache", M) {
+  UseRootPath root(RIPATH);
+
+  const string name = "Новая папка";
+  const IndexPtr ri = make_shared<Index>(name);
+
+  IndexCache::Stamp stamp;
+  REQUIRE_FALSE(IndexCache::stamp("not_found", &stamp));
+  REQUIRE(IndexCache::stamp(name, &stamp));
+
+  REQUIRE(IndexCache::find(name) == nullptr);
+
+  IndexCache::insert(name, stamp, ri);
+  REQUIRE(IndexCache::find(name) == ri);
+
+  SECTION("invalidate") {
+    IndexCache::invalidate(name);
+    REQUIRE(IndexCache::find(name) == nullptr);
+  }
+
+  SECTION("modified file") {
+    IndexCache::insert(name, {stamp.size + 1, stamp.mtime}, ri);
+    REQUIRE(IndexCache::find(name) == nullptr);
+  }
+
+  IndexCache::clear();
+}
+
+TEST_CASE("index cache only keeps recently used indexes alive", M) {
+  UseRootPath root(RIPATH);
+
+  const string names[] = {"Новая папка", "broken", "future_version",
+    "invalid_version", "wrong_root"};
+
+  IndexPtr used;
+  weak_ptr<const Index> unused;
+
+  for(const string &name : names) {
+    IndexCache::Stamp stamp;
+    REQUIRE(IndexCache::stamp(name, &stamp));
+
+    const IndexPtr ri = make_shared<Index>(name);
+    IndexCache::insert(name, stamp, ri);
+
+    if(name == names[0])
+      unused = ri;
+    else if(name == names[1])
+      used = ri;
+  }
+
+  // the first unused index was pushed out by the four that came after it
+  REQUIRE(unused.expired());
+  REQUIRE(IndexCache::find(names[0]) == nullptr);
+
+  REQUIRE(IndexCache::find(names[1]) == used);
+  REQUIRE(IndexCache::find(names[4]) != nullptr);
+
+  IndexCache::clear();
+}
@@ -85,9 +85,10 @@ TEST_CASE("read version time", M) {
   CHECK(ri->packages().size() == 1);
 
   const Time &time = ri->category(0)->package(0)->version(0)->time();
-  REQUIRE(time.year() == 2016);
-  REQUIRE(time.month() == 2);
-  REQUIRE(time.day() == 12);
+  const Time::Fields &fields = time.fields();
+  REQUIRE(fields.year == 2016);
+  REQUIRE(fields.month == 2);
+  REQUIRE(fields.day == 12);
 }
 
 TEST_CASE("invalid version tag", M) {
@@ -0,0 +1,110 @@
+#include <catch.hpp>
+
+#include <journal.hpp>
+
+#include <filesystem.hpp>
+#include <path.hpp>
+
+using namespace std;
+
+static const char *M = "[journal]";
+
+#define RIPATH "test"
+
+static const string URL = "http://example.com/file.lua";
+static const string ID = "Remote/Category/Package v1.0";
+
+TEST_CASE("adopt staged file", M) {
+  UseRootPath root(RIPATH);
+  const TempPath paths(Path("journal_test.lua"));
+
+  Journal journal{Path()};
+  REQUIRE_FALSE(journal.adopt(paths, URL, ID));
+
+  journal.plan(paths, URL, ID);
+  REQUIRE(FS::write(paths.temp(), "hello world"));
+  REQUIRE_FALSE(journal.adopt(paths, URL, ID)); // not completed
+
+  journal.staged(paths);
+
+  SECTION("match") {
+    REQUIRE(journal.adopt(paths, URL, ID));
+  }
+
+  SECTION("different url") {
+    REQUIRE_FALSE(journal.adopt(paths, URL + "?v2", ID));
+  }
+
+  SECTION("different identity") {
+    REQUIRE_FALSE(journal.adopt(paths, URL, "Remote/Category/Package v1.1"));
+  }
+
+  SECTION("modified file") {
+    REQUIRE(FS::write(paths.temp(), "hello world!"));
+    REQUIRE_FALSE(journal.adopt(paths, URL, ID));
+  }
+
+  SECTION("modified file of the same size") {
+    REQUIRE(FS::write(paths.temp(), "hello_world"));
+    REQUIRE_FALSE(journal.adopt(paths, URL, ID));
+  }
+
+  SECTION("missing file") {
+    REQUIRE(FS::remove(paths.temp()));
+    REQUIRE_FALSE(journal.adopt(paths, URL, ID));
+  }
+
+  journal.purge();
+  REQUIRE_FALSE(FS::exists(paths.temp()));
+  REQUIRE_FALSE(journal.adopt(paths, URL, ID));
+}
+
+TEST_CASE("resume interrupted download", M) {
+  UseRootPath root(RIPATH);
+  const TempPath paths(Path("journal_test.lua"));
+
+  Journal journal{Path()};
+  REQUIRE(journal.resumable(paths, URL, ID) == 0);
+
+  journal.plan(paths, URL, ID);
+  REQUIRE(FS::write(paths.temp(), "hello"));
+
+  REQUIRE(journal.resumable(paths, URL, ID) == 5);
+  REQUIRE(journal.resumable(paths, URL + "?v2", ID) == 0);
+  REQUIRE(journal.resumable(paths, URL, "Remote/Category/Package v1.1") == 0);
+
+  journal.staged(paths);
+  REQUIRE(journal.resumable(paths, URL, ID) == 0); // completed
+
+  journal.purge();
+}
+
+TEST_CASE("purge only owned staged files", M) {
+  UseRootPath root(RIPATH);
+  const TempPath mine(Path("journal_mine.lua")),
+    theirs(Path("journal_theirs.lua"));
+  const Path db("journal_purge.db");
+  FS::remove(db);
+
+  {
+    Journal interrupted(Path::prefixRoot(db));
+    interrupted.plan(theirs, URL, ID);
+    REQUIRE(FS::write(theirs.temp(), "hello"));
+  }
+
+  {
+    Journal journal(Path::prefixRoot(db));
+    journal.plan(mine, URL, ID);
+    REQUIRE(FS::write(mine.temp(), "world"));
+    REQUIRE(FS::write(mine.validator(), "\"etag\""));
+
+    journal.purge();
+    REQUIRE_FALSE(FS::exists(mine.temp()));
+    REQUIRE_FALSE(FS::exists(mine.validator()));
+    REQUIRE(FS::exists(theirs.temp())); // may still be resumed later
+    REQUIRE(journal.resumable(theirs, URL, ID) == 5);
+  }
+
+  FS::remove(theirs.temp());
+  FS::remove(db);
+}
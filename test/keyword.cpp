@@ -0,0 +1,20 @@
+#include <catch.hpp>
+
+#include <keyword.hpp>
+
+static const char *M = "[keyword]";
+
+TEST_CASE("keyword hash", M) {
+  REQUIRE(Keyword("hello").hash() == KeywordHash("hello"));
+  REQUIRE(Keyword("hello world", 5).hash() == KeywordHash("hello"));
+  REQUIRE(Keyword("").hash() == KeywordHash(""));
+  REQUIRE(KeywordHash("hello") != KeywordHash("world"));
+}
+
+TEST_CASE("keyword equality", M) {
+  REQUIRE(Keyword("hello") == "hello");
+  REQUIRE_FALSE(Keyword("hello") == "hell");
+  REQUIRE_FALSE(Keyword("hell") == "hello");
+  REQUIRE(Keyword("hello world", 5) == "hello");
+  REQUIRE_FALSE(Keyword("hello world", 5) == "hello world");
+}
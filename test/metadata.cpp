@@ -48,4 +48,8 @@ TEST_CASE("about text", M) {
 
   md.setAbout("Hello World");
   REQUIRE(md.about() == "Hello World");
+
+  const char *text = "Referenced";
+  md.setAboutRef(text);
+  REQUIRE(md.about() == "Referenced");
 }
@@ -106,11 +106,11 @@ TEST_CASE("package versions are sorted", M) {
   Package pack(Package::ScriptType, "a", &cat);
   CHECK(pack.versions().size() == 0);
 
-  Version *final = new Version("1", &pack);
-  final->addSource(new Source({}, "google.com", final));
+  Version *final = ri.arena()->make<Version>("1", &pack);
+  final->addSource(ri.arena()->make<Source>(string(), "google.com", final));
 
-  Version *alpha = new Version("0.1", &pack);
-  alpha->addSource(new Source({}, "google.com", alpha));
+  Version *alpha = ri.arena()->make<Version>("0.1", &pack);
+  alpha->addSource(ri.arena()->make<Source>(string(), "google.com", alpha));
 
   REQUIRE(pack.addVersion(final));
   REQUIRE(final->package() == &pack);
@@ -129,16 +129,16 @@ TEST_CASE("get latest stable version", M) {
   Category cat("Category Name", &ri);
   Package pack(Package::ScriptType, "a", &cat);
 
-  Version *alpha = new Version("2.0-alpha", &pack);
-  alpha->addSource(new Source({}, "google.com", alpha));
+  Version *alpha = ri.arena()->make<Version>("2.0-alpha", &pack);
+  alpha->addSource(ri.arena()->make<Source>(string(), "google.com", alpha));
   REQUIRE(pack.addVersion(alpha));
 
   SECTION("only prereleases are available")
     REQUIRE(pack.lastVersion(false) == nullptr);
 
   SECTION("an older stable release is available") {
-    Version *final = new Version("1.0", &pack);
-    final->addSource(new Source({}, "google.com", final));
+    Version *final = ri.arena()->make<Version>("1.0", &pack);
+    final->addSource(ri.arena()->make<Source>(string(), "google.com", final));
     pack.addVersion(final);
 
     REQUIRE(pack.lastVersion(false) == final);
@@ -153,32 +153,34 @@ TEST_CASE("pre-release updates", M) {
   Category cat("Category Name", &ri);
   Package pack(Package::ScriptType, "a", &cat);
 
-  Version *stable1 = new Version("0.9", &pack);
-  stable1->addSource(new Source({}, "google.com", stable1));
+  Version *stable1 = ri.arena()->make<Version>("0.9", &pack);
+  stable1->addSource(ri.arena()->make<Source>(string(), "google.com", stable1));
   pack.addVersion(stable1);
 
-  Version *alpha1 = new Version("1.0-alpha1", &pack);
-  alpha1->addSource(new Source({}, "google.com", alpha1));
+  Version *alpha1 = ri.arena()->make<Version>("1.0-alpha1", &pack);
+  alpha1->addSource(ri.arena()->make<Source>(string(), "google.com", alpha1));
   pack.addVersion(alpha1);
 
-  Version *alpha2 = new Version("1.0-alpha2", &pack);
-  alpha2->addSource(new Source({}, "google.com", alpha2));
+  Version *alpha2 = ri.arena()->make<Version>("1.0-alpha2", &pack);
+  alpha2->addSource(ri.arena()->make<Source>(string(), "google.com", alpha2));
   pack.addVersion(alpha2);
 
   SECTION("pre-release to next pre-release")
     REQUIRE(pack.lastVersion(false, {"1.0-alpha1"}) == alpha2);
 
   SECTION("pre-release to latest stable") {
-    Version *stable2 = new Version("1.0", &pack);
-    stable2->addSource(new Source({}, "google.com", stable2));
+    Version *stable2 = ri.arena()->make<Version>("1.0", &pack);
+    stable2->addSource(
+      ri.arena()->make<Source>(string(), "google.com", stable2));
     pack.addVersion(stable2);
 
-    Version *stable3 = new Version("1.1", &pack);
-    stable3->addSource(new Source({}, "google.com", stable3));
+    Version *stable3 = ri.arena()->make<Version>("1.1", &pack);
+    stable3->addSource(
+      ri.arena()->make<Source>(string(), "google.com", stable3));
     pack.addVersion(stable3);
 
-    Version *beta = new Version("2.0-beta", &pack);
-    beta->addSource(new Source({}, "google.com", beta));
+    Version *beta = ri.arena()->make<Version>("2.0-beta", &pack);
+    beta->addSource(ri.arena()->make<Source>(string(), "google.com", beta));
     pack.addVersion(beta);
 
     REQUIRE(pack.lastVersion(false, {"1.0-alpha1"}) == stable3);
@@ -194,17 +196,17 @@ TEST_CASE("drop empty version", M) {
 }
 
 TEST_CASE("add owned version", M) {
+  Arena arena;
   Package pack1(Package::ScriptType, "a", nullptr);
   Package pack2(Package::ScriptType, "a", nullptr);
 
-  Version *ver = new Version("1", &pack1);
+  Version *ver = arena.make<Version>("1", &pack1);
 
   try {
     pack2.addVersion(ver);
     FAIL();
   }
   catch(const reapack_error &e) {
-    delete ver;
     REQUIRE(string(e.what()) == "version belongs to another package");
   }
 }
@@ -214,8 +216,8 @@ TEST_CASE("add duplicate version", M) {
   Category cat("c", &ri);
   Package pack(Package::ScriptType, "p", &cat);
 
-  Version *ver = new Version("1", &pack);
-  ver->addSource(new Source({}, "google.com", ver));
+  Version *ver = ri.arena()->make<Version>("1", &pack);
+  ver->addSource(ri.arena()->make<Source>(string(), "google.com", ver));
   pack.addVersion(ver);
 
   try {
@@ -234,8 +236,8 @@ TEST_CASE("find matching version", M) {
   Package pack(Package::ScriptType, "a", &cat);
   CHECK(pack.versions().size() == 0);
 
-  Version *ver = new Version("1", &pack);
-  ver->addSource(new Source({}, "google.com", ver));
+  Version *ver = ri.arena()->make<Version>("1", &pack);
+  ver->addSource(ri.arena()->make<Source>(string(), "google.com", ver));
 
   REQUIRE(pack.findVersion({"1"}) == nullptr);
   REQUIRE(pack.findVersion({"2"}) == nullptr);
@@ -276,3 +278,43 @@ TEST_CASE("package display name", M) {
   REQUIRE(pack.displayName(false) == "test.lua");
   REQUIRE(pack.displayName(true) == "hello world");
 }
+
+TEST_CASE("versions added out of order", M) {
+  Index ri("Remote Name");
+  Category cat("Category Name", &ri);
+  Package pack(Package::ScriptType, "a", &cat);
+
+  const char *names[] = {"1.0", "3.0-beta", "0.5", "2.0", "1.5"};
+  for(const char *name : names) {
+    Version *ver = ri.arena()->make<Version>(name, &pack);
+    ver->addSource(ri.arena()->make<Source>(string(), "google.com", ver));
+    REQUIRE(pack.addVersion(ver));
+  }
+
+  REQUIRE(pack.versions().size() == 5);
+  REQUIRE(pack.version(0)->name().toString() == "0.5");
+  REQUIRE(pack.version(1)->name().toString() == "1.0");
+  REQUIRE(pack.version(2)->name().toString() == "1.5");
+  REQUIRE(pack.version(3)->name().toString() == "2.0");
+  REQUIRE(pack.version(4)->name().toString() == "3.0-beta");
+
+  REQUIRE(pack.lastVersion() == pack.version(4));
+  REQUIRE(pack.lastVersion(false) == pack.version(3));
+  REQUIRE(pack.lastVersion(false, {"2.1"}) == nullptr);
+  REQUIRE(pack.lastVersion(false, {"3.0-alpha"}) == pack.version(4));
+
+  REQUIRE(pack.findVersion({"1.5"}) == pack.version(2));
+  REQUIRE(pack.findVersion({"1.6"}) == nullptr);
+  REQUIRE(pack.findVersion({"4.0"}) == nullptr);
+
+  Version *dup = ri.arena()->make<Version>("1.5", &pack);
+  dup->addSource(ri.arena()->make<Source>(string(), "google.com", dup));
+
+  try {
+    pack.addVersion(dup);
+    FAIL();
+  }
+  catch(const reapack_error &e) {
+    REQUIRE(string(e.what()) == "duplicate version 'Remote Name/Category Name/a v1.5'");
+  }
+}
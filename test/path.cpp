@@ -242,4 +242,48 @@ TEST_CASE("temporary path") {
 
   REQUIRE(a.target() == Path("hello/world"));
   REQUIRE(a.temp() == Path("hello/world.part"));
+  REQUIRE(a.validator() == Path("hello/world.part.validator"));
 }
+
+TEST_CASE("path ordering", M) {
+  // compared component by component
+  REQUIRE(Path("a/b") < Path("a.c"));
+  REQUIRE_FALSE(Path("a.c") < Path("a/b"));
+  REQUIRE(Path("a") < Path("a/b"));
+  REQUIRE(Path("a/b") < Path("ab"));
+  REQUIRE(Path("a/b") < Path("a/c"));
+  REQUIRE_FALSE(Path("a/b") < Path("a/b"));
+}
+
+TEST_CASE("modify path components", M) {
+  Path a("hello/world/test");
+
+  a[1] = "chunky";
+  REQUIRE(a == Path("hello/chunky/test"));
+  REQUIRE(a.size() == 3);
+
+  a[2] += ".part";
+  REQUIRE(a.last() == "test.part");
+  REQUIRE(a[0] == "hello");
+}
+
+#ifndef _WIN32
+TEST_CASE("absolute path components", M) {
+  Path a("/usr/bin");
+  REQUIRE(a == Path("usr/bin"));
+  REQUIRE(a.first() == "usr");
+  REQUIRE(a.dirname().join() == "/usr");
+
+  a.removeLast();
+  a.removeLast();
+  REQUIRE(a.empty());
+  REQUIRE(a.join().empty());
+
+  a.append("etc");
+  REQUIRE(a.join() == "/etc");
+
+  Path b("/usr");
+  b.append(Path("/local/bin"));
+  REQUIRE(b.join() == "/usr/local/bin");
+}
+#endif
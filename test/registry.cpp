@@ -5,6 +5,8 @@
 #include <registry.hpp>
 
 #include <errors.hpp>
+#include <database.hpp>
+#include <filesystem.hpp>
 #include <index.hpp>
 #include <package.hpp>
 #include <remote.hpp>
@@ -20,7 +22,7 @@ static const char *M = "[registry]";
   pkg.setDescription("Hello World"); \
   Version ver("1.0", &pkg); \
   ver.setAuthor("John Doe"); \
-  Source *src = new Source("file", "url", &ver); \
+  Source *src = ri.arena()->make<Source>("file", "url", &ver); \
   ver.addSource(src);
 
 TEST_CASE("query uninstalled package", M) {
@@ -64,7 +66,7 @@ TEST_CASE("bump version", M) {
   MAKE_PACKAGE
 
   Version ver2("2.0", &pkg);
-  ver2.addSource(new Source("file", "url", &ver2));
+  ver2.addSource(ri.arena()->make<Source>("file", "url", &ver2));
 
   Registry reg;
   reg.push(&ver);
@@ -117,6 +119,26 @@ TEST_CASE("query all packages", M) {
   REQUIRE(entries[0].author == "John Doe");
 }
 
+TEST_CASE("bulk entry lookup", M) {
+  MAKE_PACKAGE
+
+  Package other(Package::ScriptType, "World", &cat);
+
+  Registry reg;
+  reg.push(&ver);
+
+  const Registry::EntryMap entries(reg.getEntries("Remote Name"));
+  REQUIRE(entries.size() == 1);
+
+  const Registry::Entry &entry = entries.find(&pkg);
+  REQUIRE(entry);
+  REQUIRE(entry.id == reg.getEntry(&pkg).id);
+  REQUIRE(entry.package == "Hello");
+  REQUIRE(entry.version.toString() == "1.0");
+
+  REQUIRE_FALSE(entries.find(&other));
+}
+
 TEST_CASE("forget registry entry", M) {
   MAKE_PACKAGE
 
@@ -127,6 +149,34 @@ TEST_CASE("forget registry entry", M) {
   REQUIRE(afterForget.id == 0); // uninstalled
 }
 
+TEST_CASE("forget the last entry of a remote", M) {
+  MAKE_PACKAGE
+
+  const Path path("registry_orphans.db");
+  FS::remove(path);
+
+  {
+    Registry reg(path);
+    reg.forget(reg.push(&ver));
+    reg.commit();
+
+    {
+      Database db(path.join());
+      Statement *count = db.prepare("SELECT"
+        "  (SELECT COUNT(*) FROM remotes) + (SELECT COUNT(*) FROM categories)");
+
+      int64_t rows = -1;
+      count->exec([&] { rows = count->intColumn(0); return false; });
+      REQUIRE(rows == 0);
+    }
+
+    // installing again recreates the rows
+    REQUIRE(reg.push(&ver));
+  }
+
+  FS::remove(path);
+}
+
 TEST_CASE("file conflicts", M) {
   Registry reg;
 
@@ -139,43 +189,107 @@ TEST_CASE("file conflicts", M) {
   Category cat("Category Name", &ri);
   Package pkg(Package::ScriptType, "Duplicate Package", &cat);
   Version ver("1.0", &pkg);
-  Source *src1 = new Source("file", "url", &ver);
+  Source *src1 = ri.arena()->make<Source>("file", "url", &ver);
   ver.addSource(src1);
-  Source *src2 = new Source("file2", "url", &ver);
+  Source *src2 = ri.arena()->make<Source>("file2", "url", &ver);
   ver.addSource(src2);
 
   CHECK(reg.getEntry(&pkg).id == 0); // uninstalled
 
+  // push() is not atomic by itself, the caller's savepoint is rolled back
+  reg.savepoint();
+
   try {
     reg.push(&ver);
     FAIL("duplicate is accepted");
   }
-  catch(const reapack_error &) {}
+  catch(const reapack_error &) {
+    reg.restore();
+  }
 
   CHECK(reg.getEntry(&pkg).id == 0); // still uninstalled
 
-  vector<Path> conflicts;
-  const auto &pushResult = reg.push(&ver, &conflicts);
-  CHECK(pushResult.id == 0);
-
+  const auto &conflicts = reg.conflicts({&ver});
   REQUIRE(conflicts.size() == 1);
-  REQUIRE(conflicts[0] == src1->targetPath());
+  REQUIRE(conflicts[0].version == &ver);
+  REQUIRE(conflicts[0].path == src1->targetPath());
+  REQUIRE(conflicts[0].owner == "Remote Name/Category Name/Hello v1.0");
 
   REQUIRE(reg.getEntry(&pkg).id == 0); // never installed
 }
 
+TEST_CASE("batch file conflicts", M) {
+  Registry reg;
+
+  Index ri("Remote Name");
+  Category cat("Category Name", &ri);
+
+  Package pkg1(Package::ScriptType, "Package 1", &cat);
+  Version ver1("1.0", &pkg1);
+  ver1.addSource(ri.arena()->make<Source>("file1", "url", &ver1));
+  ver1.addSource(ri.arena()->make<Source>("shared", "url", &ver1));
+  reg.push(&ver1);
+
+  Package pkg2(Package::ScriptType, "Package 2", &cat);
+  Version ver2("1.0", &pkg2);
+  ver2.addSource(ri.arena()->make<Source>("file2", "url", &ver2));
+
+  Package pkg3(Package::ScriptType, "Package 3", &cat);
+  Version ver3("1.0", &pkg3);
+  ver3.addSource(ri.arena()->make<Source>("file2", "url", &ver3));
+
+  SECTION("no conflicts") {
+    REQUIRE(reg.conflicts({&ver2}).empty());
+  }
+
+  SECTION("updating the owner") {
+    Version ver1b("2.0", &pkg1);
+    ver1b.addSource(ri.arena()->make<Source>("file1", "url", &ver1b));
+    ver1b.addSource(ri.arena()->make<Source>("shared", "url", &ver1b));
+    REQUIRE(reg.conflicts({&ver1b}).empty());
+  }
+
+  SECTION("between new versions") {
+    const auto &conflicts = reg.conflicts({&ver2, &ver3});
+    REQUIRE(conflicts.size() == 1);
+    REQUIRE(conflicts[0].version == &ver3);
+    REQUIRE(conflicts[0].owner == ver2.fullName());
+  }
+
+  SECTION("rejected versions don't own files") {
+    ver2.addSource(ri.arena()->make<Source>("shared", "url", &ver2));
+
+    const auto &conflicts = reg.conflicts({&ver2, &ver3});
+    REQUIRE(conflicts.size() == 1);
+    REQUIRE(conflicts[0].version == &ver2);
+    REQUIRE(conflicts[0].owner == "Remote Name/Category Name/Package 1 v1.0");
+  }
+
+  SECTION("files released by an update") {
+    Version ver1b("2.0", &pkg1);
+    ver1b.addSource(ri.arena()->make<Source>("file1", "url", &ver1b));
+
+    Version ver4("1.0", &pkg3);
+    ver4.addSource(ri.arena()->make<Source>("shared", "url", &ver4));
+
+    REQUIRE(reg.conflicts({&ver4}).size() == 1);
+    REQUIRE(reg.conflicts({&ver1b, &ver4}).empty());
+  }
+}
+
 TEST_CASE("get main files", M) {
   MAKE_PACKAGE
 
   Registry reg;
   REQUIRE((reg.getMainFiles({})).empty());
 
-  Source *main1 = new Source({}, "url", &ver);
+  Source *main1 = ri.arena()->make<Source>(string(), "url", &ver);
   main1->setSections(Source::MIDIEditorSection);
   main1->setTypeOverride(Package::EffectType);
   ver.addSource(main1);
 
-  Source *main2 = new Source({}, "url", &ver); // duplicate file ignored
+  // duplicate file ignored
+  Source *main2 = ri.arena()->make<Source>(string(), "url", &ver);
   main2->setSections(Source::MainSection);
   main2->setTypeOverride(Package::EffectType);
   ver.addSource(main2);
@@ -205,3 +319,293 @@ TEST_CASE("pin registry entry", M) {
   reg.setPinned(entry, false);
   REQUIRE_FALSE(reg.getEntry(&pkg).pinned);
 }
+
+TEST_CASE("file manifest", M) {
+  MAKE_PACKAGE
+
+  Registry reg;
+  const Registry::Entry &entry = reg.push(&ver);
+
+  Registry::File file = reg.getFiles(entry)[0];
+  REQUIRE_FALSE(file.hasManifest());
+
+  file.size = 42;
+  file.mtime = 1234;
+  file.checksum = 0xdeadbeef;
+  reg.setManifest(file);
+
+  file = reg.getFiles(entry)[0];
+  REQUIRE(file.hasManifest());
+  REQUIRE(file.size == 42);
+  REQUIRE(file.mtime == 1234);
+  REQUIRE(file.checksum == 0xdeadbeef);
+
+  // reinstalling forgets the previous manifest
+  reg.push(&ver);
+  REQUIRE_FALSE(reg.getFiles(entry)[0].hasManifest());
+}
+
+TEST_CASE("content store links", M) {
+  MAKE_PACKAGE
+
+  Registry reg;
+  const Registry::Entry &entry = reg.push(&ver);
+
+  Registry::File file = reg.getFiles(entry)[0];
+  REQUIRE_FALSE(file.stored);
+
+  file.size = 42;
+  file.checksum = 0xdeadbeef;
+  REQUIRE(reg.storeLinks(file) == 0);
+
+  file.stored = true;
+  reg.setManifest(file);
+  REQUIRE(reg.getFiles(entry)[0].stored);
+  REQUIRE(reg.storeLinks(file) == 1);
+
+  reg.forget(entry);
+  REQUIRE(reg.storeLinks(file) == 0);
+}
+
+TEST_CASE("entries with their files", M) {
+  MAKE_PACKAGE
+
+  Registry reg;
+  reg.push(&ver);
+
+  Package pkg2(Package::ScriptType, "Empty", &cat);
+  Version ver2("1.0", &pkg2);
+  reg.push(&ver2);
+
+  Index ri2("Other Remote");
+  Category cat2("Category Name", &ri2);
+  Package pkg3(Package::ScriptType, "Hello", &cat2);
+  Version ver3("1.0", &pkg3);
+  ver3.addSource(ri2.arena()->make<Source>("file1", "url", &ver3));
+  ver3.addSource(ri2.arena()->make<Source>("file2", "url", &ver3));
+  reg.push(&ver3);
+
+  vector<pair<Registry::Entry, vector<Registry::File> > > list;
+  const auto callback = [&] (const Registry::Entry &entry,
+      const vector<Registry::File> &files) {
+    list.push_back({entry, files});
+  };
+
+  SECTION("single remote") {
+    reg.forEachEntry(ri.name(), callback);
+
+    REQUIRE(list.size() == 2);
+    REQUIRE(list[0].first == reg.getEntry(&pkg));
+    REQUIRE(list[0].first.package == "Hello");
+    REQUIRE(list[0].second.size() == 1);
+    REQUIRE(list[0].second[0].path == src->targetPath());
+    REQUIRE(list[1].first.package == "Empty");
+    REQUIRE(list[1].second.empty());
+  }
+
+  SECTION("whole registry") {
+    reg.forEachEntry(callback);
+
+    REQUIRE(list.size() == 3);
+    REQUIRE(list[0].first.remote == ri.name());
+    REQUIRE(list[1].first.remote == ri.name());
+    REQUIRE(list[2].first.remote == ri2.name());
+    REQUIRE(list[2].second.size() == 2);
+    REQUIRE(list[2].second[1].path == reg.getFiles(list[2].first)[1].path);
+  }
+
+  SECTION("unknown remote") {
+    reg.forEachEntry("Not Installed", callback);
+    REQUIRE(list.empty());
+  }
+}
+
+TEST_CASE("read-only registry snapshot", M) {
+  MAKE_PACKAGE
+
+  const Path path("registry_snapshot.db");
+  FS::remove(path);
+
+  {
+    Registry writer(path);
+    writer.push(&ver);
+
+    // the writer holds its lock until commit, readers still get in
+    {
+      Registry reader(path, Registry::ReadOnly);
+      REQUIRE_FALSE(reader.getEntry(&pkg));
+    }
+
+    writer.commit();
+
+    Registry reader(path, Registry::ReadOnly);
+    REQUIRE(reader.getEntry(&pkg));
+    REQUIRE_THROWS(reader.forget(reader.getEntry(&pkg)));
+
+    Registry writer2(path);
+    writer2.forget(writer2.getEntry(&pkg));
+    writer2.commit();
+
+    // same snapshot for the lifetime of the reader
+    REQUIRE(reader.getEntry(&pkg));
+  }
+
+  FS::remove(path);
+}
+
+TEST_CASE("read-only registry does not create the file", M) {
+  MAKE_PACKAGE
+
+  const Path path("registry_missing.db");
+  FS::remove(path);
+
+  {
+    Registry reader(path, Registry::ReadOnly);
+    REQUIRE_FALSE(reader.getEntry(&pkg));
+    REQUIRE(reader.getEntries(ri.name()).empty());
+  }
+
+  REQUIRE_FALSE(FS::exists(path));
+
+  FS::remove(path);
+}
+
+TEST_CASE("migrate implicit sections from v0.4", M) {
+  const Path path("registry_migration.db");
+  FS::remove(path);
+
+  {
+    Database db(path.join());
+    db.exec(
+      "CREATE TABLE entries ("
+      "  id INTEGER PRIMARY KEY,"
+      "  remote TEXT NOT NULL,"
+      "  category TEXT NOT NULL,"
+      "  package TEXT NOT NULL,"
+      "  desc TEXT NOT NULL,"
+      "  type INTEGER NOT NULL,"
+      "  version TEXT NOT NULL,"
+      "  author TEXT NOT NULL,"
+      "  pinned INTEGER DEFAULT 0,"
+      "  UNIQUE(remote, category, package)"
+      ");"
+
+      "CREATE TABLE files ("
+      "  id INTEGER PRIMARY KEY,"
+      "  entry INTEGER NOT NULL,"
+      "  path TEXT UNIQUE NOT NULL,"
+      "  main INTEGER NOT NULL,"
+      "  type INTEGER NOT NULL,"
+      "  FOREIGN KEY(entry) REFERENCES entries(id)"
+      ");"
+
+      "INSERT INTO entries VALUES(1, 'Remote', 'Category', 'a',"
+      "  '', 1, '1.0', '', 0);"
+      "INSERT INTO entries VALUES(2, 'Remote', 'MIDI Editor/Sub', 'b',"
+      "  '', 1, '1.0', '', 0);"
+      "INSERT INTO files VALUES(1, 1, 'Scripts/Remote/a', 1, 0);"
+      "INSERT INTO files VALUES(2, 1, 'Scripts/Remote/a.dat', 0, 0);"
+      "INSERT INTO files VALUES(3, 2, 'Scripts/Remote/b', 1, 0);"
+    );
+    db.setVersion({0, 4});
+  }
+
+  {
+    Registry reg(path);
+    reg.commit();
+  }
+
+  {
+    Database db(path.join());
+
+    vector<int> sections;
+    Statement *select = db.prepare("SELECT main FROM files ORDER BY id");
+    select->exec([&] {
+      sections.push_back(select->intColumn(0));
+      return true;
+    });
+
+    REQUIRE(sections == (vector<int>{
+      Source::MainSection, 0, Source::MIDIEditorSection}));
+  }
+
+  FS::remove(path);
+}
+
+TEST_CASE("migrate registry from v0.5", M) {
+  MAKE_PACKAGE
+
+  const Path path("registry_migration.db");
+  FS::remove(path);
+
+  {
+    Database db(path.join());
+    db.exec(
+      "CREATE TABLE entries ("
+      "  id INTEGER PRIMARY KEY,"
+      "  remote TEXT NOT NULL,"
+      "  category TEXT NOT NULL,"
+      "  package TEXT NOT NULL,"
+      "  desc TEXT NOT NULL,"
+      "  type INTEGER NOT NULL,"
+      "  version TEXT NOT NULL,"
+      "  author TEXT NOT NULL,"
+      "  pinned INTEGER DEFAULT 0,"
+      "  UNIQUE(remote, category, package)"
+      ");"
+
+      "CREATE TABLE files ("
+      "  id INTEGER PRIMARY KEY,"
+      "  entry INTEGER NOT NULL,"
+      "  path TEXT UNIQUE NOT NULL,"
+      "  main INTEGER NOT NULL,"
+      "  type INTEGER NOT NULL,"
+      "  FOREIGN KEY(entry) REFERENCES entries(id)"
+      ");"
+
+      "INSERT INTO entries VALUES(42, 'Remote Name', 'Category Name', 'Hello',"
+      "  'Hello World', 1, '1.0', 'John Doe', 1);"
+      "INSERT INTO files VALUES(NULL, 42, 'Scripts/Remote Name/file', 1, 0);"
+    );
+    db.setVersion({0, 5});
+  }
+
+  {
+    // readers never write to the database, they upgrade a copy in memory
+    Registry reader(path, Registry::ReadOnly);
+    REQUIRE(reader.getEntry(&pkg).id == 42);
+    REQUIRE(reader.getEntries(ri.name()).size() == 1);
+
+    Database db(path.join(), Database::ReadOnly);
+    REQUIRE(db.version() < (Database::Version{0, 6}));
+  }
+
+  {
+    Registry reg(path);
+    reg.commit();
+
+    const Registry::Entry &entry = reg.getEntry(&pkg);
+    REQUIRE(entry.id == 42);
+    REQUIRE(entry.remote == "Remote Name");
+    REQUIRE(entry.category == "Category Name");
+    REQUIRE(entry.description == "Hello World");
+    REQUIRE(entry.version.toString() == "1.0");
+    REQUIRE(entry.pinned);
+
+    REQUIRE(reg.getEntries(ri.name()).size() == 1);
+
+    const auto &files = reg.getFiles(entry);
+    REQUIRE(files.size() == 1);
+    REQUIRE_FALSE(files[0].hasManifest());
+
+    // the migrated schema accepts new entries and files
+    Package pkg2(Package::ScriptType, "Hello 2", &cat);
+    Version ver2("2.0", &pkg2);
+    ver2.addSource(ri.arena()->make<Source>("file2", "url", &ver2));
+
+    REQUIRE(reg.push(&ver2));
+    REQUIRE(reg.getEntries(ri.name()).size() == 2);
+  }
+
+  FS::remove(path);
+}
@@ -61,6 +61,17 @@ TEST_CASE("parse file section", M) {
   REQUIRE(Source::MIDIInlineEditorSection == Source::getSection("midi_inline_editor"));
 }
 
+TEST_CASE("parse section list", M) {
+  REQUIRE(0 == Source::getSections(""));
+  REQUIRE(0 == Source::getSections("hello"));
+  REQUIRE(Source::MainSection == Source::getSections("main"));
+  REQUIRE(Source::MainSection == Source::getSections(" main "));
+  REQUIRE((Source::MainSection | Source::MIDIEditorSection) ==
+    Source::getSections("main  midi_editor"));
+  REQUIRE(Source::MIDIEditorSection == Source::getSections("mai midi_editor"));
+  REQUIRE(-1 == Source::getSections("true"));
+}
+
 TEST_CASE("explicit source section", M) {
   MAKE_VERSION;
 
@@ -239,3 +250,25 @@ TEST_CASE("directory traversal in category name", M) {
 
   REQUIRE(src.targetPath() == expected);
 }
+
+TEST_CASE("source file names are shared within an index", M) {
+  MAKE_VERSION;
+
+  Source src1("file.lua", "url1", &ver);
+  Source src2("file.lua", "url2", &ver);
+
+  REQUIRE(&src1.file() == &src2.file());
+  REQUIRE(ri.strings()->intern("file.lua") == &src1.file());
+}
+
+TEST_CASE("cached target path", M) {
+  MAKE_VERSION;
+
+  Source src("file.lua", "url", &ver);
+  const Path &path = src.targetPath();
+  REQUIRE(&src.targetPath() == &path);
+  REQUIRE(path.first() == "Data");
+
+  src.setTypeOverride(Package::ScriptType);
+  REQUIRE(src.targetPath().first() == "Scripts");
+}
@@ -0,0 +1,54 @@
+#include <catch.hpp>
+
+#include <store.hpp>
+
+#include <filesystem.hpp>
+#include <verifier.hpp>
+
+static const char *M = "[store]";
+
+#define RIPATH "test"
+
+TEST_CASE("share identical files", M) {
+  UseRootPath root(RIPATH);
+
+  Registry::File a{Path("store_test_a.wav")};
+  Registry::File b{Path("store_test_b.wav")};
+  REQUIRE(FS::write(a.path, "hello world"));
+  REQUIRE(FS::write(b.path, "hello world"));
+  REQUIRE(FileVerifier::record(&a));
+  REQUIRE(FileVerifier::record(&b));
+
+  const Path &stored = ContentStore::pathFor(a);
+  REQUIRE(stored == ContentStore::pathFor(b));
+  REQUIRE_FALSE(FS::exists(stored));
+
+  REQUIRE(ContentStore::link(&a));
+  REQUIRE(a.stored);
+  REQUIRE(FS::exists(stored));
+
+  REQUIRE(ContentStore::link(&b));
+  REQUIRE(b.stored);
+  REQUIRE(FileVerifier::verify(&b) == FileVerifier::Intact);
+
+  SECTION("same checksum, different contents") {
+    Registry::File c{Path("store_test_c.wav")};
+    REQUIRE(FS::write(c.path, "HELLO WORLD"));
+    REQUIRE(FileVerifier::record(&c));
+    c.checksum = a.checksum;
+
+    REQUIRE_FALSE(ContentStore::link(&c));
+    REQUIRE_FALSE(c.stored);
+    REQUIRE(FS::remove(c.path));
+  }
+
+  ContentStore::release(a);
+  REQUIRE_FALSE(FS::exists(stored));
+
+  // the installed links keep the contents
+  REQUIRE(FileVerifier::verify(&a) == FileVerifier::Intact);
+
+  REQUIRE(FS::remove(a.path));
+  REQUIRE(FS::remove(b.path));
+  REQUIRE(FS::remove(Path::DATA));
+}
@@ -0,0 +1,68 @@
+#include <catch.hpp>
+
+#include <stringpool.hpp>
+
+using namespace std;
+
+static const char *M = "[stringpool]";
+
+TEST_CASE("intern identical strings", M) {
+  StringPool pool;
+  const string *a = pool.intern("hello");
+  const string *b = pool.intern(string("hel") + "lo");
+
+  REQUIRE(a == b);
+  REQUIRE(*a == "hello");
+  REQUIRE(pool.size() == 1);
+}
+
+TEST_CASE("intern distinct strings", M) {
+  StringPool pool;
+  const string *a = pool.intern("hello");
+  const string *b = pool.intern("world");
+
+  REQUIRE(a != b);
+  REQUIRE(*a == "hello");
+  REQUIRE(*b == "world");
+  REQUIRE(pool.size() == 2);
+}
+
+TEST_CASE("interned strings are stable", M) {
+  StringPool pool;
+  const string *first = pool.intern("first");
+
+  for(int i = 0; i < 1000; i++)
+    pool.intern(to_string(i));
+
+  REQUIRE(pool.intern("first") == first);
+  REQUIRE(*first == "first");
+}
+
+TEST_CASE("separate pools do not share strings", M) {
+  StringPool a, b;
+  REQUIRE(a.intern("hello") != b.intern("hello"));
+}
+
+TEST_CASE("pooled strings", M) {
+  StringPool pool;
+  const PooledString a("hello", &pool), b("hello", &pool);
+
+  REQUIRE(a.str() == "hello");
+  REQUIRE(a.get() == b.get());
+  REQUIRE(pool.size() == 1);
+}
+
+TEST_CASE("unpooled strings own a copy", M) {
+  const PooledString a("hello", nullptr), b("hello", nullptr);
+
+  REQUIRE(a.str() == "hello");
+  REQUIRE(a.get() != b.get());
+}
+
+TEST_CASE("default pooled string", M) {
+  PooledString str;
+  REQUIRE(str.str().empty());
+
+  str.assign("world", nullptr);
+  REQUIRE(str.str() == "world");
+}
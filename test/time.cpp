@@ -10,17 +10,39 @@ static const char *M = "[time]";
 
 TEST_CASE("valid time", M) {
   const Time time("2016-02-12T01:16:40Z");
-  REQUIRE(time.year() == 2016);
-  REQUIRE(time.month() == 2);
-  REQUIRE(time.day() == 12);
-  REQUIRE(time.hour() == 1);
-  REQUIRE(time.minute() == 16);
-  REQUIRE(time.second() == 40);
+  const Time::Fields &fields = time.fields();
+  REQUIRE(fields.year == 2016);
+  REQUIRE(fields.month == 2);
+  REQUIRE(fields.day == 12);
+  REQUIRE(fields.hour == 1);
+  REQUIRE(fields.minute == 16);
+  REQUIRE(fields.second == 40);
   REQUIRE(time == Time(2016, 2, 12, 1, 16, 40));
   REQUIRE(time.isValid());
   REQUIRE(time);
 }
 
+TEST_CASE("time epoch", M) {
+  REQUIRE(Time("1970-01-01T00:00:00Z").epoch() == 0);
+  REQUIRE(Time("2016-02-12T01:16:40Z").epoch() == 1455239800);
+  REQUIRE(Time(2016, 2, 12, 1, 16, 40).epoch() == 1455239800);
+  REQUIRE(Time("1901-01-01T00:00:00Z").isValid());
+  REQUIRE_FALSE(Time("1900-12-31T23:59:59Z").isValid());
+}
+
+TEST_CASE("truncated time string", M) {
+  REQUIRE_FALSE(Time("2016-02-12").isValid());
+  REQUIRE_FALSE(Time("2016-02-12T01:16").isValid());
+  REQUIRE_FALSE(Time("").isValid());
+}
+
+TEST_CASE("single digit time fields", M) {
+  REQUIRE(Time("2016-2-3T4:5:6Z") == Time(2016, 2, 3, 4, 5, 6));
+  REQUIRE(Time("2016-02-3T04:5:06Z") == Time(2016, 2, 3, 4, 5, 6));
+  REQUIRE_FALSE(Time("2016--03T04:05:06Z").isValid());
+  REQUIRE_FALSE(Time("2016-002-03T04:05:06Z").isValid());
+}
+
 TEST_CASE("garbage time string", M) {
   const Time time("hello world");
   REQUIRE_FALSE(time.isValid());
@@ -0,0 +1,65 @@
+#include <catch.hpp>
+
+#include <verifier.hpp>
+
+#include <index.hpp>
+
+static const char *M = "[verifier]";
+
+#define RIPATH "test/indexes"
+
+TEST_CASE("record file manifest", M) {
+  UseRootPath root(RIPATH);
+
+  Registry::File file{Index::pathFor("Новая папка")};
+  REQUIRE(FileVerifier::record(&file));
+  REQUIRE(file.hasManifest());
+  REQUIRE(file.size == 21);
+  REQUIRE(file.checksum == 0x8fd0d4de);
+
+  Registry::File missing{Index::pathFor("not_found")};
+  REQUIRE_FALSE(FileVerifier::record(&missing));
+  REQUIRE_FALSE(missing.hasManifest());
+}
+
+TEST_CASE("verify file manifest", M) {
+  UseRootPath root(RIPATH);
+
+  Registry::File file{Index::pathFor("Новая папка")};
+  REQUIRE(FileVerifier::record(&file));
+
+  SECTION("intact") {
+    REQUIRE(FileVerifier::verify(&file) == FileVerifier::Intact);
+  }
+
+  SECTION("same contents, different mtime") {
+    const int64_t mtime = file.mtime;
+    file.mtime = 0;
+    REQUIRE(FileVerifier::verify(&file) == FileVerifier::Updated);
+    REQUIRE(file.mtime == mtime);
+  }
+
+  SECTION("different contents") {
+    file.mtime = 0;
+    file.checksum = ~file.checksum;
+    REQUIRE(FileVerifier::verify(&file) == FileVerifier::Modified);
+  }
+
+  SECTION("different size") {
+    file.size = 42;
+    REQUIRE(FileVerifier::verify(&file) == FileVerifier::Modified);
+  }
+
+  SECTION("no manifest") {
+    Registry::File legacy{file.path};
+    legacy.size = -1;
+    REQUIRE(FileVerifier::verify(&legacy) == FileVerifier::Updated);
+    REQUIRE(legacy.size == file.size);
+    REQUIRE(legacy.checksum == file.checksum);
+  }
+
+  SECTION("missing") {
+    Registry::File missing{Index::pathFor("not_found")};
+    REQUIRE(FileVerifier::verify(&missing) == FileVerifier::Missing);
+  }
+}
@@ -168,6 +168,24 @@ TEST_CASE("compare versions with more or less segments", M) {
   REQUIRE(VersionName("1.0.0.1") != VersionName("1"));
 }
 
+TEST_CASE("compare versions with zero segments", M) {
+  REQUIRE(VersionName("1.0.0-beta") < VersionName("1"));
+  REQUIRE(VersionName("1") > VersionName("1.0.0-beta"));
+  REQUIRE(VersionName("1.0.0.2") > VersionName("1"));
+  REQUIRE(VersionName("1.0.2") < VersionName("1.1-beta"));
+  REQUIRE(VersionName("1.0.0-beta") < VersionName("1.0.0.0-beta"));
+  REQUIRE(VersionName("1-beta.0") == VersionName("1-beta"));
+  REQUIRE(VersionName("1.256") > VersionName("1.255"));
+  REQUIRE(VersionName("1.65535") > VersionName("1.256"));
+}
+
+TEST_CASE("compare version letters", M) {
+  REQUIRE(VersionName("1.0-alpha") < VersionName("1.0-alphab"));
+  REQUIRE(VersionName("1.0-alpha2") > VersionName("1.0-alpha"));
+  REQUIRE(VersionName("1.0-Beta") < VersionName("1.0-beta"));
+  REQUIRE(VersionName("1.0-rc") == VersionName("1.0rc"));
+}
+
 TEST_CASE("prerelease versions", M) {
   SECTION("detect") {
     REQUIRE(VersionName("1.0").isStable());
@@ -208,7 +226,7 @@ TEST_CASE("add source", M) {
   Version ver("1.0", &pkg);
   CHECK(ver.sources().size() == 0);
 
-  Source *src = new Source("a", "b", &ver);
+  Source *src = ri.arena()->make<Source>("a", "b", &ver);
   REQUIRE(ver.addSource(src));
 
   CHECK(ver.sources().size() == 1);
@@ -216,16 +234,16 @@ TEST_CASE("add source", M) {
 }
 
 TEST_CASE("add owned source", M) {
+  Arena arena;
   Version ver1("1", nullptr);
   Version ver2("1", nullptr);
-  Source *src = new Source("a", "b", &ver2);
+  Source *src = arena.make<Source>("a", "b", &ver2);
 
   try {
     ver1.addSource(src);
     FAIL();
   }
   catch(const reapack_error &e) {
-    delete src;
     REQUIRE(string(e.what()) == "source belongs to another version");
   }
 }
@@ -234,7 +252,7 @@ TEST_CASE("duplicate sources", M) {
   MAKE_PACKAGE;
   Version ver("1.0", &pkg);
 
-  Source *src = new Source({}, "b", &ver);
+  Source *src = ri.arena()->make<Source>(string(), "b", &ver);
   CHECK(ver.addSource(src) == true);
   REQUIRE(ver.addSource(src) == false);
 
@@ -246,7 +264,7 @@ TEST_CASE("list files", M) {
   MAKE_PACKAGE;
   Version ver("1.0", &pkg);
 
-  Source *src1 = new Source("file", "url", &ver);
+  Source *src1 = ri.arena()->make<Source>("file", "url", &ver);
   ver.addSource(src1);
 
   Path path1;
@@ -281,12 +299,27 @@ TEST_CASE("version author", M) {
   REQUIRE(Version::displayAuthor("cfillion") == "cfillion");
 }
 
+TEST_CASE("set version changelog", M) {
+  Version ver("1.0", nullptr);
+  CHECK(ver.changelog().empty());
+
+  ver.setChangelog("Hello");
+  REQUIRE(ver.changelog() == "Hello");
+
+  const char *text = "World";
+  ver.setChangelogRef(text);
+  REQUIRE(ver.changelog() == "World");
+
+  ver.setChangelog("Hello again");
+  REQUIRE(ver.changelog() == "Hello again");
+}
+
 TEST_CASE("version date", M) {
   Version ver("1.0", nullptr);
 
   ver.setTime("2016-02-12T01:16:40Z");
-  REQUIRE(ver.time().year() == 2016);
+  REQUIRE(ver.time().fields().year == 2016);
 
   ver.setTime("hello world");
-  REQUIRE(ver.time().year() == 2016);
+  REQUIRE(ver.time().fields().year == 2016);
 }